@@ -0,0 +1,46 @@
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+
+using namespace std;
+
+//============================================================================//
+int main(int argc,char *argv[])
+// job program of the benchmark
+//   -m noop  : exit at once
+//   -m sleep : sleep -t sec.
+//   -m burn  : use -t sec. of CPU time
+//============================================================================//
+{
+  const char *mode = "noop";
+  double sec = 0.0;
+
+  // for options
+  for( int i = 1 ; i < argc ; i++ ) {
+    if( !strncmp(argv[i],"-m",2) && i+1 < argc ) {
+      mode = argv[++i];
+    }
+    else if( !strncmp(argv[i],"-t",2) && i+1 < argc ) {
+      sec = atof(argv[++i]);
+    }
+  }
+
+  if( !strcmp(mode,"sleep") ) {
+    usleep((useconds_t)(sec * 1.0e6));
+  }
+  else if( !strcmp(mode,"burn") ) {
+    volatile double x = 0.0;
+    clock_t end = clock() + (clock_t)(sec * CLOCKS_PER_SEC);
+    while( clock() < end ) {
+      for( int k = 0 ; k < 10000 ; k++ ) x += k * 0.5;
+    }
+  }
+  else if( strcmp(mode,"noop") ) {
+    cerr << "[ERROR] -m : noop, sleep or burn." << endl;
+    return 1;
+  }
+
+  return 0;
+}
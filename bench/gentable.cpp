@@ -0,0 +1,122 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+
+using namespace std;
+
+//============================================================================//
+void line(ostream &out,const int jo,const int id,const string &dep,const string &cmd)
+// a table line ( task id <TAB> depend task ids <TAB> command for -jo 1 )
+//============================================================================//
+{
+  if( jo ) {
+    out << id << "\t" << dep << "\t";
+  }
+  out << cmd << endl;
+}
+
+//============================================================================//
+int main(int argc,char *argv[])
+// synthetic table of MPIDP for the benchmark
+//   -g indep : -n independent jobs
+//   -g chain : -n jobs, job i depends on job i-1
+//   -g fan   : -d stages of fan-out to -w jobs and fan-in to one job
+//============================================================================//
+{
+  string shape = "indep";
+  string cmd;
+  string out_file;
+  int njob = 100;
+  int width = 10;
+  int depth = 1;
+  int jo = 0;
+
+  // for options
+  for( int i = 1 ; i < argc-1 ; i++ ) {
+    if( !strncmp(argv[i],"-g",2) ) {
+      shape = argv[++i];
+    }
+    else if( !strncmp(argv[i],"-n",2) ) {
+      njob = atoi(argv[++i]);
+    }
+    else if( !strncmp(argv[i],"-w",2) ) {
+      width = atoi(argv[++i]);
+    }
+    else if( !strncmp(argv[i],"-d",2) ) {
+      depth = atoi(argv[++i]);
+    }
+    else if( !strncmp(argv[i],"-c",2) ) {
+      cmd = argv[++i];
+    }
+    else if( !strncmp(argv[i],"-jo",3) ) {
+      jo = atoi(argv[++i]);
+    }
+    else if( !strncmp(argv[i],"-o",2) ) {
+      out_file = argv[++i];
+    }
+  }
+
+  if( cmd.empty() ) {
+    cerr << "Usage: gentable -c command [-g indep|chain|fan] [-n jobs] [-w width] [-d depth]"
+         << " [-jo 0|1] [-o table]" << endl;
+    return 1;
+  }
+  if( shape != "indep" && shape != "chain" && shape != "fan" ) {
+    cerr << "[ERROR] -g : indep, chain or fan." << endl;
+    return 1;
+  }
+  if( shape != "indep" ) {
+    jo = 1;      // dependencies need JOB ORDER mode
+  }
+  if( njob < 1 || width < 1 || depth < 1 ) {
+    cerr << "[ERROR] -n, -w and -d : 1 or more." << endl;
+    return 1;
+  }
+
+  ofstream file;
+  if( !out_file.empty() ) {
+    file.open(out_file.c_str());
+    if( !file ) {
+      cerr << "[ERROR] Table file [" << out_file << "] was not opened!!" << endl;
+      return 1;
+    }
+  }
+  ostream &out = out_file.empty() ? cout : file;
+
+  out << "TITLE=bench " << shape << endl;
+
+  if( shape == "indep" ) {
+    for( int i = 1 ; i <= njob ; i++ ) {
+      line(out,jo,i,"",cmd);
+    }
+  }
+  else if( shape == "chain" ) {
+    for( int i = 1 ; i <= njob ; i++ ) {
+      ostringstream dep;
+      if( i > 1 ) dep << i-1;
+      line(out,jo,i,dep.str(),cmd);
+    }
+  }
+  else {
+    // root, and width jobs + one join job for each stage
+    int id = 1;
+    int join = id;
+    line(out,jo,id++,"",cmd);
+    for( int d = 0 ; d < depth ; d++ ) {
+      ostringstream dep, fanin;
+      dep << join;
+      for( int w = 0 ; w < width ; w++ ) {
+        if( w ) fanin << ",";
+        fanin << id;
+        line(out,jo,id++,dep.str(),cmd);
+      }
+      join = id;
+      line(out,jo,id++,fanin.str(),cmd);
+    }
+  }
+
+  return 0;
+}
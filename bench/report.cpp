@@ -0,0 +1,141 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cctype>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+using namespace std;
+
+//============================================================================//
+double percentile(vector<double> &v,const double p)
+// p-th percentile of v (v is sorted)
+//============================================================================//
+{
+  if( v.empty() ) return 0.0;
+  int k = (int)(p / 100.0 * (v.size()-1) + 0.5);
+  return v[k];
+}
+
+//============================================================================//
+double value(const string &s,const char *key)
+// value of "key=" in s (-1 : not found)
+//============================================================================//
+{
+  size_t pos = s.find(key);
+  if( pos == string::npos ) return -1.0;
+  return atof(s.c_str() + pos + strlen(key));
+}
+
+//============================================================================//
+int main(int argc,char *argv[])
+// one line report of an MPIDP run for the benchmark
+//   jobs/sec. of the master, dispatch latency (WAIT) percentiles, and
+//   makespan vs. ideal = max(total run time / job slots, critical path)
+//============================================================================//
+{
+  string log_file = "./mpidp.log";
+  string table_file;
+  string label = "-";
+
+  // for options
+  for( int i = 1 ; i < argc-1 ; i++ ) {
+    if( !strncmp(argv[i],"-lg",3) ) {
+      log_file = argv[++i];
+    }
+    else if( !strncmp(argv[i],"-tb",3) ) {
+      table_file = argv[++i];
+    }
+    else if( !strncmp(argv[i],"-l",2) ) {
+      label = argv[++i];
+    }
+  }
+
+  ifstream Input(log_file.c_str());
+  if( !Input ) {
+    cerr << "[ERROR] Log file [" << log_file << "] was not opened!!" << endl;
+    return 1;
+  }
+
+  int nrank = 0, slot = 1, table = 0;
+  double elapsed = 0.0;
+  vector<double> run;      // run time of the last returned attempt of each job
+  vector<double> wait;     // dispatch latency of all returned attempts
+  string s;
+
+  while( getline(Input,s) ) {
+    if( !strncmp(s.c_str(),"#RANK = ",8) ) {
+      nrank = atoi(s.c_str()+8);
+    }
+    else if( !strncmp(s.c_str(),"Job slots",9) ) {
+      slot = atoi(s.c_str() + s.find("-sl") + 3);
+    }
+    else if( !strncmp(s.c_str(),"JOB table",9) ) {
+      table = 1;
+    }
+    else if( table && s.empty() ) {
+      table = 0;
+    }
+    else if( table ) {
+      double r = 0.0;
+      size_t pos = 0;
+      while( (pos = s.find("(WID=",pos)) != string::npos ) {
+        string a = s.substr(pos,s.find(')',pos)-pos);
+        if( value(a,"END=") == 1.0 ) {
+          wait.push_back(value(a,"WAIT="));
+          r = value(a,"RUN=");
+        }
+        pos++;
+      }
+      run.push_back(r);
+    }
+    else if( !strncmp(s.c_str(),"Elapsed time",12) ) {
+      elapsed = atof(s.c_str() + s.find('=') + 1);
+    }
+  }
+
+  // critical path of the table (-jo 1 tables have task id and depend columns)
+  double path = 0.0;
+  if( !table_file.empty() ) {
+    ifstream Table(table_file.c_str());
+    map<string,int> id;
+    vector<double> finish;
+    while( getline(Table,s) ) {
+      if( s.empty() || !strncmp(s.c_str(),"TITLE=",6) || !strncmp(s.c_str(),"PARAM=",6) ) continue;
+      int j = finish.size();
+      double start = 0.0;
+      size_t t1 = s.find('\t');
+      size_t t2 = (t1 == string::npos) ? t1 : s.find('\t',t1+1);
+      if( t2 != string::npos && isdigit(s[0]) ) {
+        id[s.substr(0,t1)] = j;
+        stringstream dep(s.substr(t1+1,t2-t1-1));
+        string d;
+        while( getline(dep,d,',') ) {
+          if( id.count(d) ) start = max(start,finish[id[d]]);
+        }
+      }
+      finish.push_back(start + (j < run.size() ? run[j] : 0.0));
+      path = max(path,finish.back());
+    }
+  }
+
+  double total = 0.0;
+  for( int j = 0 ; j < run.size() ; j++ ) total += run[j];
+  int nslot = max(nrank-1,1) * slot;
+  double ideal = max(total / nslot,path);
+
+  sort(wait.begin(),wait.end());
+  printf("%-16s %5d %5d %7d %10.3f %10.3f %7.3f %10.1f %8.2f %8.2f %8.2f %8.2f\n",
+         label.c_str(),nrank,nslot,(int)run.size(),elapsed,ideal,
+         (ideal > 0.0) ? elapsed/ideal : 0.0,
+         (elapsed > 0.0) ? run.size()/elapsed : 0.0,
+         percentile(wait,50)*1000.0,percentile(wait,90)*1000.0,
+         percentile(wait,99)*1000.0,wait.empty() ? 0.0 : wait.back()*1000.0);
+
+  return 0;
+}
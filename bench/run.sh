@@ -0,0 +1,53 @@
+#!/bin/sh
+
+################################################
+# Dispatch throughput benchmark of MPIDP
+#   (make bench in the top directory first)
+#
+#   NP     : rank counts (master + workers)
+#   NJOB   : jobs of indep and chain tables
+#   WIDTH  : width of fan tables
+#   DEPTH  : stages of fan tables
+#   JOB    : job program mode (noop, sleep or burn)
+#   SEC    : seconds of sleep and burn jobs
+#   OPT    : other MPIDP options (e.g. "-pf 2 -sl 2")
+################################################
+mpidp="../mpidp"
+NP=${NP:-"2 4 8"}
+NJOB=${NJOB:-1000}
+WIDTH=${WIDTH:-16}
+DEPTH=${DEPTH:-8}
+JOB=${JOB:-noop}
+SEC=${SEC:-0}
+OPT=${OPT:-""}
+################################################
+
+mpi_opt="--allow-run-as-root --oversubscribe"
+work="./work"
+mkdir -p $work
+job="`pwd`/benchjob -m $JOB -t $SEC"
+
+echo "START>>> bench (job = $JOB $SEC sec.)"
+echo "                 ranks slots    jobs   makespan      ideal   ratio    jobs/s  wait-p50 wait-p90 wait-p99 wait-max (msec)"
+
+# shape  master  -jo  MPIDP options
+while read shape master jo mopt; do
+  table="$work/$shape.$jo"
+  ./gentable -g $shape -n $NJOB -w $WIDTH -d $DEPTH -jo $jo -c "$job" -o $table || exit 1
+
+  for np in $NP; do
+    log="$work/$shape.$master.$np.log"
+    mpirun $mpi_opt -np $np $mpidp -tb $table -lg $log $mopt $OPT < /dev/null > /dev/null
+    ./report -lg $log -tb $table -l "$shape/$master"
+  done
+done <<EOF
+indep master0 0 -jo 0
+indep master  0 -jo 0 -rt 1
+indep master1 1 -jo 1
+chain master1 1 -jo 1
+chain master  1 -jo 1 -rt 1
+fan   master1 1 -jo 1
+fan   master  1 -jo 1 -rt 1
+EOF
+
+echo "END>>>>> bench"
@@ -15,6 +15,8 @@
 int application(int argc,char *argv[]);
 #endif
 
+extern char **environ;
+
 //============================================================================//
 int main(int argc,char *argv[])
 //============================================================================//
@@ -55,19 +57,12 @@ int main(int argc,char *argv[])
     logout << "      mpidp@bi.cs.titech.ac.jp   last updated: " << LASTUPDATED << endl << endl;
     logout << "#RANK = " << nproc << endl;
 
-    int nprocess = 1;        // # of processes in one core
-    string *shost = new string[nproc];    // Hostname
-    shost[0] = &hostall[0];
-    for( int i = 1 ; i < nproc ; i++ ) {
-      shost[i] = &hostall[i*MPI_MAX_PROCESSOR_NAME];
-      if( shost[i] == shost[0] ) {
-        nprocess ++;
-      }
-      else {
-        break;
-      }
+    int nprocess = 1;        // # of processes in one node (the most)
+    map<string,int> shost;    // Hostname -> # of ranks (ranks need not be contiguous)
+    for( int i = 0 ; i < nproc ; i++ ) {
+      nprocess = max(nprocess,++shost[&hostall[i*MPI_MAX_PROCESSOR_NAME]]);
     }
-    logout << "#Node = " << nproc/nprocess << " (#RANK/Node = " << nprocess << ")" << endl;
+    logout << "#Node = " << shost.size() << " (#RANK/Node = " << nprocess << ")" << endl;
 
     logout << "\n used nodes list(id) :";
     for( int i = 0 ; i < nproc ; i++ ) {
@@ -78,8 +73,10 @@ int main(int argc,char *argv[])
     }
     logout << endl << endl;
     logout.flush();
-    delete [] shost;
   }
+
+  // Sub-masters on each node (-hm)
+  mpidp.make_Hierarchy(argc,argv,nproc,myid,hostall,logout);
   delete [] hostall;
 
   if( myid == 0 ) {      // for master
@@ -89,6 +86,17 @@ int main(int argc,char *argv[])
     // Read command options and JOB list
     mpidp.read_table(argc,argv,ntry,logout);
 
+    // only the compiled table is written (-cp with one rank)
+    if( mpidp.compileOnly(nproc) ) {
+      etime = MPI_Wtime();
+      MPI_Finalize();
+      logout << "\nElapsed time  = " << etime - stime << " sec." << endl;
+      return 0;
+    }
+
+    // the journal is opened only for a run (-jn)
+    mpidp.open_journal();
+
     if( ntry == 0 ) {      // case of NO retry
       if( mpidp._Job_order ) {
         eflag = mpidp.master1(nproc);  // = 0 (MPI_Finalize) or 1 (MPI_Abort)
@@ -98,9 +106,13 @@ int main(int argc,char *argv[])
       }
     }
     else {
-      eflag = mpidp.master(nproc);  // = 1 (MPI_Abort)
+      eflag = mpidp.master(nproc);  // = 0 (MPI_Finalize) or 1 (MPI_Abort)
     }
 
+    mpidp.close_journal();
+    mpidp.write_status(1);
+    mpidp.write_history();
+    mpidp.write_trace(nproc);
     mpidp.write_table(nproc,logout);  // write JOB and Workers report
 
     if( eflag ) {
@@ -109,6 +121,9 @@ int main(int argc,char *argv[])
       MPI_Abort(MPI_COMM_WORLD,1);
     }
   }
+  else if( mpidp.isSubmaster() ) {  // for sub-masters
+    mpidp.submaster(myid,argc,argv);
+  }
   else {        // for workers
     mpidp.worker(myid,hostname,argc,argv);
   }
@@ -131,7 +146,6 @@ void Mpidp::read_table(int argc,char *argv[],int &ntry,ofstream &logout)
 //============================================================================//
 {
   int csize = 0;
-  int ndata = 0;
   string table;
 
   _Title = "MPIDP ";
@@ -142,6 +156,38 @@ void Mpidp::read_table(int argc,char *argv[],int &ntry,ofstream &logout)
   _Ntry = 0;        // Number retrying limit
   _Worker_life = 3;      // Worker life (default=3)
   _Job_order = 0;                       // Job ordering mode
+  _Priority = 0;                        // Ready job priority mode
+  _Cost_column = 0;                     // Cost column (0: cost = 1)
+  _Chunk = 1;                           // Chunk size (lines / dispatch)
+  _Chunk_mode = 0;                      // Chunk mode (0: fixed)
+  _Prefetch = 1;                        // Messages queued on a worker
+  _Slot = 1;                            // Jobs run at once on a worker
+  _Launcher = 0;                        // Job launcher (0: /bin/sh)
+  _Journal_file = "";                   // Completion journal (none)
+  _Restart = 0;                         // Restart mode (0: run all jobs)
+  _Journal_fd = -1;
+  _Make = 0;                            // Incremental mode (0: run all jobs)
+  _In_column.clear();                   // Input file columns (none)
+  _Cache_dir = "";                      // Result cache directory (none)
+  _Heartbeat = 0.0;                     // Heartbeat interval (none)
+  _Deadline = 0.0;                      // Time limit of each job (none)
+  _Backup = 0;                          // Backup execution (0: none)
+  _Start_time = MPI_Wtime();
+  _Trace_file = "";                     // Trace file (none)
+  _Status_file = "";                    // Status file (none)
+  _Status_interval = 10.0;              // Status interval (10 sec.)
+  _Status_time = -1.0;
+  _Status_ndone = 0;
+  _History_file = "";                   // Runtime history (none)
+  _Npredict = 0;
+  _Host_column = 0;                     // Preferred host column (none)
+  _Host_delay = 5.0;                    // Delay for the host (5 sec.)
+  _Compile_file = "";                   // Compiled table (none)
+  _Wakeup = 0.0;
+  _Core_column = 0;                     // Cores column (1 core)
+  _Mem_column = 0;                      // Memory column (none)
+  _Node_core = 0;                       // Cores of a node (job slots)
+  _Node_mem = 0.0;                      // Memory of a node (no limit)
 
   // for MPIDP options
   for( int i = 1 ; i < argc ; i++ ) {
@@ -165,6 +211,113 @@ void Mpidp::read_table(int argc,char *argv[],int &ntry,ofstream &logout)
       _Job_order = atoi(argv[++i]);
       logout << "JOB Order     : -jo " << _Job_order << endl;
     }
+    else if( !strcmp(argv[i],"-pr") ) {
+      _Priority = atoi(argv[++i]);
+      logout << "Priority      : -pr " << _Priority << endl;
+    }
+    else if( !strcmp(argv[i],"-cc") ) {
+      _Cost_column = atoi(argv[++i]);
+      logout << "Cost column   : -cc " << _Cost_column << endl;
+    }
+    else if( !strcmp(argv[i],"-ck") ) {
+      _Chunk = atoi(argv[++i]);
+      logout << "Chunk size    : -ck " << _Chunk << endl;
+    }
+    else if( !strcmp(argv[i],"-cm") ) {
+      _Chunk_mode = atoi(argv[++i]);
+      logout << "Chunk mode    : -cm " << _Chunk_mode << endl;
+    }
+    else if( !strcmp(argv[i],"-pf") ) {
+      _Prefetch = atoi(argv[++i]);
+      logout << "Prefetch      : -pf " << _Prefetch << endl;
+    }
+    else if( !strcmp(argv[i],"-sl") ) {
+      _Slot = atoi(argv[++i]);
+      logout << "Job slots     : -sl " << _Slot << endl;
+    }
+    else if( !strcmp(argv[i],"-ln") ) {
+      _Launcher = atoi(argv[++i]);
+      logout << "Launcher      : -ln " << _Launcher << endl;
+    }
+    else if( !strcmp(argv[i],"-jn") ) {
+      _Journal_file = argv[++i];
+      logout << "Journal file  : -jn " << _Journal_file << endl;
+    }
+    else if( !strcmp(argv[i],"-rs") ) {
+      _Restart = atoi(argv[++i]);
+      logout << "Restart       : -rs " << _Restart << endl;
+    }
+    else if( !strcmp(argv[i],"-mk") ) {
+      _Make = atoi(argv[++i]);
+      logout << "Incremental   : -mk " << _Make << endl;
+    }
+    else if( !strcmp(argv[i],"-ic") ) {
+      split_columns(argv[++i],_In_column);
+      logout << "Input columns : -ic " << argv[i] << endl;
+    }
+    else if( !strcmp(argv[i],"-ch") ) {
+      _Cache_dir = argv[++i];
+      logout << "Result cache  : -ch " << _Cache_dir << endl;
+    }
+    else if( !strcmp(argv[i],"-hb") ) {
+      _Heartbeat = atof(argv[++i]);
+      logout << "Heartbeat     : -hb " << _Heartbeat << endl;
+    }
+    else if( !strcmp(argv[i],"-dl") ) {
+      _Deadline = atof(argv[++i]);
+      logout << "Job deadline  : -dl " << _Deadline << endl;
+    }
+    else if( !strcmp(argv[i],"-bk") ) {
+      _Backup = atoi(argv[++i]);
+      logout << "Backup jobs   : -bk " << _Backup << endl;
+    }
+    else if( !strcmp(argv[i],"-tr") ) {
+      _Trace_file = argv[++i];
+      logout << "Trace file    : -tr " << _Trace_file << endl;
+    }
+    else if( !strcmp(argv[i],"-st") ) {
+      _Status_file = argv[++i];
+      logout << "Status file   : -st " << _Status_file << endl;
+    }
+    else if( !strcmp(argv[i],"-hc") ) {
+      _Host_column = atoi(argv[++i]);
+      logout << "Host column   : -hc " << _Host_column << endl;
+    }
+    else if( !strcmp(argv[i],"-hd") ) {
+      _Host_delay = atof(argv[++i]);
+      logout << "Host delay    : -hd " << _Host_delay << endl;
+    }
+    else if( !strcmp(argv[i],"-cp") ) {
+      _Compile_file = argv[++i];
+      logout << "Compiled table: -cp " << _Compile_file << endl;
+    }
+    else if( !strcmp(argv[i],"-rc") ) {
+      _Core_column = atoi(argv[++i]);
+      logout << "Core column   : -rc " << _Core_column << endl;
+    }
+    else if( !strcmp(argv[i],"-rm") ) {
+      _Mem_column = atoi(argv[++i]);
+      logout << "Memory column : -rm " << _Mem_column << endl;
+    }
+    else if( !strcmp(argv[i],"-nc") ) {
+      _Node_core = atoi(argv[++i]);
+      logout << "Node cores    : -nc " << _Node_core << endl;
+    }
+    else if( !strcmp(argv[i],"-nm") ) {
+      _Node_mem = atof(argv[++i]);
+      logout << "Node memory   : -nm " << _Node_mem << " MB" << endl;
+    }
+    else if( !strcmp(argv[i],"-hs") ) {
+      _History_file = argv[++i];
+      logout << "History file  : -hs " << _History_file << endl;
+    }
+    else if( !strcmp(argv[i],"-si") ) {
+      _Status_interval = atof(argv[++i]);
+      logout << "Status every  : -si " << _Status_interval << endl;
+    }
+    else if( !strcmp(argv[i],"-hm") ) {
+      logout << "Sub-masters   : -hm " << argv[++i] << endl;
+    }
     else if( !strncmp(argv[i],"-pg",3) ) {
       logout << "Program name  : -pg " << argv[++i] << endl;
     }
@@ -179,8 +332,145 @@ void Mpidp::read_table(int argc,char *argv[],int &ntry,ofstream &logout)
     MPI_Abort(MPI_COMM_WORLD,1);
     exit(1);
   }
-  if(_Job_order == 1 && _Ntry > 0) {
-    cerr << "[ERROR] -rt > 0 & -jo 1 is impossible mode." << endl;
+  if(_Priority != 0 && _Priority != 1) {
+    cerr << "[ERROR] -pr : 0 or 1." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+  if(_Chunk < 1) {
+    cerr << "[ERROR] -ck : 1 or more." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+  if(_Chunk_mode < 0 || _Chunk_mode > 2) {
+    cerr << "[ERROR] -cm : 0(fixed), 1(guided) or 2(factoring)." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+  if((_Chunk > 1 || _Chunk_mode > 0) && (_Job_order == 1 || _Ntry > 0)) {
+    cerr << "[ERROR] -ck and -cm are available for -jo 0 & -rt 0 only." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+  if(_Prefetch < 1) {
+    cerr << "[ERROR] -pf : 1 or more." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+  if(_Slot < 1) {
+    cerr << "[ERROR] -sl : 1 or more." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+  if(_Launcher != 0 && _Launcher != 1) {
+    cerr << "[ERROR] -ln : 0(shell) or 1(direct)." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+#ifndef SYSTEMCALL
+  if(_Slot > 1) {
+    cerr << "[ERROR] -sl > 1 is available for system call version only." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+  if(_Launcher > 0) {
+    cerr << "[ERROR] -ln is available for system call version only." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+#endif
+  if(_Hierarchy > 0 && (_Job_order == 1 || _Ntry > 0)) {
+    cerr << "[ERROR] -hm is available for -jo 0 & -rt 0 only." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+  if(_Restart != 0 && _Restart != 1) {
+    cerr << "[ERROR] -rs : 0 or 1." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+  if(_Restart == 1 && _Journal_file.empty()) {
+    cerr << "[ERROR] -rs 1 needs -jn." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+  if(_Make != 0 && _Make != 1) {
+    cerr << "[ERROR] -mk : 0 or 1." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+  if(_Make == 1 && _Out_option <= 0) {
+    cerr << "[ERROR] -mk 1 needs -ot (output file column)." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+  for( int i = 0 ; i < _In_column.size() ; i++ ) {
+    if(_In_column[i] < 1) {
+      cerr << "[ERROR] -ic : column numbers (1,2,...) separated by comma." << endl;
+      MPI_Abort(MPI_COMM_WORLD,1);
+      exit(1);
+    }
+  }
+  if(!_Cache_dir.empty() && _Out_option <= 0) {
+    cerr << "[ERROR] -ch needs -ot (output file column)." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+#ifndef SYSTEMCALL
+  if(!_Cache_dir.empty()) {
+    cerr << "[ERROR] -ch is available for system call version only." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+#endif
+  if(_Heartbeat < 0.0 || _Deadline < 0.0) {
+    cerr << "[ERROR] -hb and -dl : 0 (none) or seconds." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+  if(_Backup != 0 && _Backup != 1) {
+    cerr << "[ERROR] -bk : 0 or 1." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+  if(_Backup == 1 && (_Job_order == 1 || _Ntry > 0)) {
+    cerr << "[ERROR] -bk is available for -jo 0 & -rt 0 only." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+  if(_Backup == 1 && _Prefetch > 1) {
+    cerr << "[ERROR] -bk is available for -pf 1 only (a prefetched job is not running)." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+  if(_Backup == 1 && _Out_option == 0) {
+    cerr << "[ERROR] -bk needs -ot (output file column)." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+  if(_Host_column < 0 || _Host_delay < 0.0) {
+    cerr << "[ERROR] -hc : column (0: none), -hd : 0 or seconds." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+  if(_Host_column > 0 && (_Job_order == 1 || _Ntry > 0)) {
+    cerr << "[ERROR] -hc is available for -jo 0 & -rt 0 only." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+  if(_Core_column < 0 || _Mem_column < 0 || _Node_core < 0 || _Node_mem < 0.0) {
+    cerr << "[ERROR] -rc, -rm : column (0: none), -nc, -nm : 0 (default) or more." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+  if((_Core_column > 0 || _Mem_column > 0) &&
+     (_Job_order == 1 || _Ntry > 0 || _Backup == 1 || _Host_column > 0)) {
+    cerr << "[ERROR] -rc and -rm are available for -jo 0 & -rt 0 without -bk and -hc." << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+  if(_Status_interval <= 0.0) {
+    cerr << "[ERROR] -si : seconds (more than 0)." << endl;
     MPI_Abort(MPI_COMM_WORLD,1);
     exit(1);
   }
@@ -188,13 +478,7 @@ void Mpidp::read_table(int argc,char *argv[],int &ntry,ofstream &logout)
   // for other(application's) options
   int oflag = 0;
   for( int i = 1 ; i < argc ; i++ ) {
-    if( !strncmp(argv[i],"-tb",3) ||
-        !strncmp(argv[i],"-ot",3) ||
-        !strncmp(argv[i],"-rt",3) ||
-        !strncmp(argv[i],"-wl",3) ||
-        !strncmp(argv[i],"-jo",3) ||
-        !strncmp(argv[i],"-pg",3) ||
-        !strncmp(argv[i],"-lg",3) ) {
+    if( mpidp_option(argv[i]) || !strncmp(argv[i],"-pg",3) ) {
       i++;
     }
     else {
@@ -219,9 +503,34 @@ void Mpidp::read_table(int argc,char *argv[],int &ntry,ofstream &logout)
     exit(1);
   }
 
-  // read JOB list file
-  while(1) {
+  vector<int> task_id;      // task id of each job (JOB ORDER mode)
+  int nline = 0;
+
+  _Dep_ptr.assign(1,0);
+  _Dep_idx.clear();
+  _Table_text.clear();
+  _Table_offset.assign(1,0);
+  _Table_njob = 0;
+  _Table_base = _Table_text.data();
+  _Table_index = &_Table_offset[0];
+  _Column_ptr = NULL;
+  _Column_off = NULL;
+
+  // a compiled table (-cp) is mapped, not read
+  int compiled = map_table(task_id,csize,logout);
+
+  // all lines are kept in one buffer of about the file size
+  if( !compiled ) {
+    Input.seekg(0,ios::end);
+    _Table_text.reserve(max((long)Input.tellg(),0L));
+    Input.seekg(0,ios::beg);
+  }
+
+  // read JOB list file (single pass)
+  while( !compiled ) {
     if( !getline(Input,table) ) break;
+    nline++;
+    if( table.empty() ) continue;
     if( !_Job_order ) {
       table = erase_space(table,7);
     }
@@ -239,123 +548,141 @@ void Mpidp::read_table(int argc,char *argv[],int &ntry,ofstream &logout)
       _Psize = _Param.size() + 1;
       logout << "PARAM=" << _Param << endl;
     }
+    else if( !_Job_order ) {
+      add_line(table.data(),table.size());
+    }
     else {
-      // JOB ORDER mode
-      if( _Job_order ) {
-        size_t i = table.rfind('\t', table.length());
-        if (i != string::npos) {
-          table = table.substr(i+1, table.length() - i);
-        }
+      // JOB ORDER mode : task id <TAB> depend ids <TAB> job line
+      const char *line = table.c_str();
+      const char *tab1 = strchr(line,'\t');
+      const char *tab2 = tab1 ? strchr(tab1+1,'\t') : NULL;
+      char *end;
+
+      if( tab2 == NULL ) {
+        cerr << "[ERROR] JOB table format : line " << nline << endl;
+        MPI_Abort(MPI_COMM_WORLD,1);
+        exit(1);
       }
 
-      _Table_list.push_back(table);
+      task_id.push_back(strtol(line,&end,10));
+      if( end == line || end != tab1 ) {
+        cerr << "[ERROR] JOB table format : line " << nline << endl;
+        MPI_Abort(MPI_COMM_WORLD,1);
+        exit(1);
+      }
 
-      if( _Table_list.back().size() > csize ) {
-        csize = _Table_list.back().size();
+      // depend task ids separated by comma (no empty id)
+      for( const char *p = tab1+1 ; p < tab2 ; p = end+1 ) {
+        _Dep_idx.push_back(strtol(p,&end,10));
+        if( end == p || end > tab2 || (end < tab2 && (*end != ',' || end+1 == tab2)) ) {
+          cerr << "[ERROR] JOB table format : line " << nline << endl;
+          MPI_Abort(MPI_COMM_WORLD,1);
+          exit(1);
+        }
       }
+      _Dep_ptr.push_back(_Dep_idx.size());
+
+      add_line(tab2+1,strlen(tab2+1));
+    }
+
+    if( table_size() > 0 && table_len(table_size()-1) > csize ) {
+      csize = table_len(table_size()-1);
     }
   }
 
   logout << endl;
 
+  if( table_size() == 0 ) {
+    cerr << "[ERROR] No JOB in table file [" << _Table_file << "]!!" << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+
+  // jobs finished in a previous run
+  _Done.assign(table_size(),0);
+  _Ndone = 0;
+  if( _Restart ) {
+    read_journal(logout);
+  }
+  if( _Make && !_Job_order ) {
+    make_Uptodate(logout);
+  }
+  _Same.assign(table_size(),-1);
+  if( !_Cache_dir.empty() && !_Job_order ) {
+    make_Same(logout);
+  }
+  if( !_History_file.empty() ) {
+    read_history(logout);
+  }
+  if( !_Job_order ) {
+    make_Order(logout);
+  }
+  if( _Core_column > 0 || _Mem_column > 0 ) {
+    make_Pack(logout);
+  }
+
   // JOB ORDER mode : make _JobControl[]
   if( _Job_order ) {
-    // read JOB list again
-    Input.clear();
-    Input.seekg(0, std::ios::beg); // rewind
-
-    int tbsize = _Table_list.size();
+    int tbsize = table_size();
     _JobControl = new JobControl[tbsize];
     clear_JobControl();
-    _jobid_map.clear();
-    _taskid_map.clear();
 
-    int ntable = 0;
-    while(1) {
-      if( !getline(Input,table) ) break;
+    // task id -> job id index
+    make_Id_index(task_id);
 
-      if( !strncmp(table.c_str(),"TITLE=",6) ||
-          !strncmp(table.c_str(),"Title=",6) ||
-          !strncmp(table.c_str(),"title=",6) ) {
+    // depend task ids -> job ids (job ids in a compiled table)
+    for( int i = 0 ; i < _Dep_idx.size() && !compiled ; i++ ) {
+      int job_id = task2job(_Dep_idx[i]);
+      if( job_id < 0 ) {
+        cerr << "[ERROR] Task id [" << _Dep_idx[i] << "] was not found in table file!!" << endl;
+        MPI_Abort(MPI_COMM_WORLD,1);
+        exit(1);
       }
-      else {
-        size_t i = table.rfind('\t', table.length());
-
-        string dep_id = "";
-        string id = "";
-        if (i != string::npos) {
-          dep_id = table.substr(0, i);
-          table = table.substr(i+1, table.length() - i);
-
-          i = dep_id.rfind('\t', dep_id.length());
-          if (i != string::npos) {
-            id = dep_id.substr(0, i);
-            dep_id = dep_id.substr(i+1, dep_id.length() - i);
-
-            // save _JobControl[].task_id
-            _JobControl[ntable].task_id = std::atoi(id.c_str());
-
-            // save _jobid_map < task id , job id >
-            _jobid_map.insert(pair<int,int>(std::atoi(id.c_str()),ntable));
-            // save _taskid_map < job id , task id >
-            _taskid_map.insert(pair<int,int>(ntable,std::atoi(id.c_str())));
-
-            if (dep_id == "") {
-              _JobControl[ntable].ready = 1;
-            }
-            else {
-              int ndepend = count_comma(dep_id) + 1;
-              
-              // save _JobControl[].depend
-              if( ndepend > 0 ) {
-                if( ndepend == 1 ) {
-                  int task_id = atoi(dep_id.c_str());
-                  _JobControl[ntable].depend.push_back(task_id);
-                }
-                else {
-                  for( int i = 0; i < ndepend - 1; i++ ) {
-                    size_t j = dep_id.rfind(',', dep_id.length());
-                    if (j != string::npos) {
-                      string depend0 = dep_id.substr(j+1, dep_id.length() - j);
-                      dep_id = dep_id.substr(0, j);
-                      int task_id = atoi(depend0.c_str());
-                      _JobControl[ntable].depend.push_back(task_id);
-
-                      // last of loop
-                      if( i == ndepend - 2) {
-                        task_id = atoi(dep_id.c_str());
-                        _JobControl[ntable].depend.push_back(task_id);
-                      }
-                    }
-                  }
-                }
-              }
-            }
-          }
-          else {
-            cout << "ERROR: JOB table format" << endl;
-            exit(1);
-          }
-        }
-        else {
-          cout << "ERROR: JOB table format" << endl;
-          exit(1);
-        }
-        ntable++;
+      _Dep_idx[i] = job_id;
+    }
+
+    // depended job ids (transpose of depend)
+    _Child_ptr.assign(tbsize+1,0);
+    _Child_idx.resize(_Dep_idx.size());
+    for( int i = 0 ; i < _Dep_idx.size() ; i++ ) {
+      _Child_ptr[_Dep_idx[i]+1] ++;
+    }
+    for( int i = 0 ; i < tbsize ; i++ ) {
+      _Child_ptr[i+1] += _Child_ptr[i];
+    }
+    vector<int> fill(_Child_ptr.begin(),_Child_ptr.end()-1);
+    for( int i = 0 ; i < tbsize ; i++ ) {
+      _JobControl[i].task_id = task_id[i];
+      _JobControl[i].nwait = _Dep_ptr[i+1] - _Dep_ptr[i];
+      for( int j = _Dep_ptr[i] ; j < _Dep_ptr[i+1] ; j++ ) {
+        _Child_idx[fill[_Dep_idx[j]]++] = i;
       }
     }
 
-    ntable = 0;
-    while(1) {
-      if (ntable == tbsize) break;
+    // critical path length of each job
+    make_Blevel(logout);
+
+    // jobs with up-to-date output (in topological order)
+    if( _Make ) {
+      make_Uptodate(logout);
+    }
+
+    // finished jobs of a previous run are done
+    for( int i = 0 ; i < tbsize ; i++ ) {
+      if( _Done[i] ) {
+        _JobControl[i].done = 1;
+        for( int j = _Child_ptr[i] ; j < _Child_ptr[i+1] ; j++ ) {
+          _JobControl[_Child_idx[j]].nwait --;
+        }
+      }
+    }
 
-      // save _JobControl[].depended
-      for(int j = 0; j < _JobControl[ntable].depend.size() ; j++ ) {
-        int task_id = _JobControl[ntable].depend[j];
-        int job_id = _jobid_map[task_id]; // task id -> job id
-        _JobControl[job_id].depended.push_back(_taskid_map[ntable]);
+    // initial ready queue
+    _Ready_queue.clear();
+    for( int i = 0 ; i < tbsize ; i++ ) {
+      if( _JobControl[i].nwait == 0 && !_Done[i] ) {
+        pushReadyJobID(i);
       }
-      ntable++;
     }
 #ifdef DEBUG_LOG
     writeJobControl();
@@ -365,16 +692,16 @@ void Mpidp::read_table(int argc,char *argv[],int &ntry,ofstream &logout)
   Input.close();
   _Csize = csize + 7;
 
-  for( int i = 0 ; i < _Table_list[0].size() ; i++ ) {
-    if( _Table_list[0].substr(i,1) == "\t" ) {
-      ndata ++;
-    }
+  if( !_Compile_file.empty() ) {
+    compile_table(task_id,csize,logout);
   }
 
   // According to _Name data
-  _Ndata = ndata + 2;
+  _Ndata = count(table_ptr(0),table_ptr(0)+table_len(0),'\t') + 2;
 
   ntry = _Ntry;
+  _Watch = (_Heartbeat > 0.0 || _Deadline > 0.0);
+  _Nlost = 0;
 
   return;
 }
@@ -413,281 +740,436 @@ int Mpidp::master0(const int &nproc)
 {
   int wid;        // Worker id
   int retry = 0;      // Retry counter
-  int ir[2];        // 0:RET and 1:FILE flags 
-  int tbsize = _Table_list.size();
-  char end_tb_flag[] = "EndOfTable";  // Table list END flag
+  vector<int> ir;      // job id, RET and FILE flags of each line in chunk
+  int tbsize = table_size();
   char *param = new char[_Psize];  // for PARAM data
 
-  // for Table list
-  char **ctable = new char*[tbsize];
-  for( int i = 0 ; i < tbsize ; i++ ) {
-    ctable[i] = new char[_Csize];
-  }
+  vector<int> chunk;      // job ids sent at once
 
   strcpy(param,_Param.c_str());
 
-  // The calculation condition is sent to workers. 
-  for( int i = 1 ; i < nproc ; i++ ) {
+  // The calculation condition is sent to workers and sub-masters.
+  int nworker = 0;      // # of workers under the master
+  int lsched[2] = { _Chunk, _Prefetch };
+  for( int m = 0 ; m < _Member.size() ; m++ ) {
+    int i = _Member[m];
     MPI_Send(&_Psize,1,MPI_INT,i,100,MPI_COMM_WORLD);
     MPI_Send(param,_Psize,MPI_CHAR,i,200,MPI_COMM_WORLD);
     MPI_Send(&_Csize,1,MPI_INT,i,300,MPI_COMM_WORLD);
     MPI_Send(&_Ndata,1,MPI_INT,i,400,MPI_COMM_WORLD);
     MPI_Send(&_Out_option,1,MPI_INT,i,420,MPI_COMM_WORLD);
+    MPI_Send(&_Slot,1,MPI_INT,i,430,MPI_COMM_WORLD);
+    MPI_Send(&_Launcher,1,MPI_INT,i,460,MPI_COMM_WORLD);
+    if( _Weight[i] > 1 ) {
+      MPI_Send(lsched,2,MPI_INT,i,440,MPI_COMM_WORLD);
+    }
+    nworker += _Weight[i] * _Slot;
   }
 
   _Namelog = new NameLog[tbsize];
   _Workerlog = new WorkerLog[nproc];
 
+  vector<int> todo;      // job ids not finished in a previous run
+  vector<char> dup(tbsize,0);  // the same line is run by an earlier job
+  for( int i = 0 ; i < tbsize ; i++ ) {
+    if( _Same[i] >= 0 ) dup[_Same[i]] = 1;
+  }
   for( int i = 0 ; i < tbsize ; i++ ) {
     sprintf(_Name,"%05d\t\0",i+1);  // Event number
-    strcpy(ctable[i],_Name);
-    strcat(ctable[i],_Table_list[i].c_str());
     _Namelog[i].name = _Name;
     _Namelog[i].exec = 1;    // EXEC flag = 1 (fixed)
 
-    _Namelog[i].rcode[0].push_back(0);
-    _Namelog[i].rcode[1].push_back(-1);
-    _Namelog[i].rcode[2].push_back(0);
+    if( _Done[i] ) {
+      _Namelog[i].exec = 0;  // skipped (restart)
+    }
+  }
+  for( int k = 0 ; k < tbsize ; k++ ) {
+    int i = _Order[k];
+    if( !_Done[i] && !dup[i] ) {
+      todo.push_back(i);
+    }
+  }
+  int ntodo = todo.size();
+
+  // jobs are taken from the queue of each node (-hc)
+  if( _Host_column > 0 ) {
+    make_Host_queue(todo);
+  }
+
+  // jobs are packed into nodes by cores and memory (-rc, -rm)
+  int pack = (_Core_column > 0 || _Mem_column > 0);
+  if( pack ) {
+    _Pack_queue.assign(todo.begin(),todo.end());
+  }
 
-    if( i < nproc-1 ) {
-      _Namelog[i].worker.push_back(i+1);
-      _Workerlog[i+1].name.push_back(_Name);
-      _Workerlog[i+1].rcode.push_back(0);
-      MPI_Send(&retry,1,MPI_INT,i+1,450,MPI_COMM_WORLD);
-      MPI_Send(ctable[i],_Csize,MPI_CHAR,i+1,500,MPI_COMM_WORLD);
+  // predicted run time of todo[k..] (-hs : a chunk has the predicted run time
+  //   of chunk_size() jobs of the mean run time)
+  vector<double> rest;
+  if( _Npredict > 0 && _Chunk_mode > 0 && _Host_column == 0 && !pack ) {
+    make_Cost();
+    rest.assign(ntodo+1,0.0);
+    for( int k = ntodo-1 ; k >= 0 ; k-- ) {
+      rest[k] = rest[k+1] + _Cost[todo[k]];
+    }
+  }
+
+  _Chunk_batch = 0;
+  initNotRunRank();
+
+  int next = 0;        // next job in todo
+  int nqueue = 0;      // # of messages not returned
+  int nfinal = 0;      // # of jobs with the final result
+  int eflag = 0;
+  deque<int> requeue;  // jobs of lost ranks
+
+  // backup copies (-bk 1) : a job has the final result when a copy succeeds
+  //   or no copy is left, and results of other copies are ignored
+  vector<int> ncopy(tbsize,0);    // # of copies not returned
+  vector<char> final(tbsize,0);   // the final result was received
+  vector<int> sent;               // job ids in the order of dispatch
+  int oldest = 0;                 // first job in sent without the final result
+
+  while( nfinal < ntodo ) {
+    int backup = -1;
+    if( _Backup && next >= ntodo && requeue.empty() && (wid = getIdleRank()) != -1 ) {
+      // the longest running job on other ranks (table list is empty)
+      while( oldest < sent.size() && (final[sent[oldest]] || _Namelog[sent[oldest]].exec > 1) ) {
+        oldest++;
+      }
+      for( int k = oldest ; k < sent.size() ; k++ ) {
+        int j = sent[k];
+        if( !final[j] && _Namelog[j].exec == 1 && _Namelog[j].worker.back() != wid ) {
+          backup = j;
+          break;
+        }
+      }
+      if( backup < 0 ) {
+        putNotRunRank(wid);
+      }
     }
-    else {
-      MPI_Recv(&wid,1,MPI_INT,MPI_ANY_SOURCE,600,MPI_COMM_WORLD,&_Status);
-      MPI_Recv(ir,2,MPI_INT,wid,550,MPI_COMM_WORLD,&_Status);
-      int nameno = atoi(_Workerlog[wid].name.back().c_str());
-      _Namelog[nameno-1].rcode[0][0] = 1;
-      _Namelog[nameno-1].rcode[1][0] = ir[0];
-      _Namelog[nameno-1].rcode[2][0] = ir[1];
 
-      _Workerlog[wid].rcode.back() = 1;
+    if( backup >= 0 ) {    // output file of a backup copy is outfile.1
+      dispatch(wid,&backup,1,1);
+      _Namelog[backup].exec ++;
+      ncopy[backup] ++;
+      nqueue++;
+    }
+    else if( (next < ntodo || !requeue.empty()) &&
+             (wid = pack ? getPackRank(chunk) :
+                    (_Host_column > 0 && requeue.empty()) ? getLocalRank(chunk,ntodo-next,nworker)
+                                                          : getNotRunRank()) != -1 ) {
+      // a sub-master takes one chunk per job slot of the workers under it
+      int nchunk = 0;
+      int nslot = (_Weight[wid] > 1) ? _Weight[wid] * _Slot : 1;
+      int suffix = retry;
+
+      if( !requeue.empty() ) {    // jobs of lost ranks first
+        suffix = _Namelog[requeue.front()].exec - 1;
+        while( nchunk < requeue.size() && nchunk < nslot*_Chunk &&
+               _Namelog[requeue[nchunk]].exec - 1 == suffix ) {
+          nchunk++;
+        }
+        chunk.assign(requeue.begin(),requeue.begin()+nchunk);
+        requeue.erase(requeue.begin(),requeue.begin()+nchunk);
+      }
+      else if( _Host_column > 0 || pack ) {    // chosen by getLocalRank() or getPackRank()
+        nchunk = chunk.size();
+        next += nchunk;
+        if( pack ) {    // one job
+          suffix = _Namelog[chunk[0]].exec - 1;
+        }
+      }
+      else {
+        for( int w = 0 ; w < nslot && next+nchunk < ntodo ; w++ ) {
+          int p = next + nchunk;
+          int n = chunk_size(ntodo-p,nworker);
+          if( !rest.empty() ) {
+            double target = n * rest[p] / (ntodo-p);
+            int q = min(p+_Chunk,ntodo);
+            while( q < ntodo && rest[p] - rest[q] < target ) q++;
+            n = q - p;
+          }
+          nchunk += n;
+        }
+        chunk.assign(todo.begin()+next,todo.begin()+next+nchunk);
+        next += nchunk;
+      }
+      dispatch(wid,&chunk[0],nchunk,suffix);
+      for( int k = 0 ; k < nchunk ; k++ ) {
+        ncopy[chunk[k]] ++;
+      }
+      sent.insert(sent.end(),chunk.begin(),chunk.end());
+      nqueue++;
+    }
+    else if( nqueue == 0 && _Wakeup == 0.0 ) {
+      cerr << "[ERROR] All workers were lost!!" << endl;
+      eflag = 1;
+      break;
+    }
+    else {
+      wid = recv_result(ir);
+      if( wid == -2 ) {    // jobs of other nodes may be taken (-hd)
+        continue;
+      }
+      if( wid < 0 ) {      // jobs of a lost rank are sent again
+        // the lost run may still be writing its output file, and the run
+        //   sent again writes outfile.<# of runs> as a backup copy does
+        deque<int> lost;
+        nqueue -= lost_Worker(_Lost,lost);
+        for( int k = 0 ; k < lost.size() ; k++ ) {
+          if( pack ) {    // cores and memory are packed again
+            release_Pack(lost[k]);
+            ncopy[lost[k]] --;
+            _Namelog[lost[k]].exec ++;
+            _Pack_queue.push_front(lost[k]);
+            next--;
+          }
+          else if( --ncopy[lost[k]] == 0 && !final[lost[k]] ) {
+            _Namelog[lost[k]].exec ++;
+            requeue.push_back(lost[k]);
+          }
+        }
+        eflag = 1;
+        continue;
+      }
+      nqueue--;
+
+      for( int k = 0 ; k < ir.size() ; k += RESULT_SIZE ) {
+        int jobid = ir[k];
+        set_Namelog(wid,&ir[k]);
+        finish_Workerlog(wid,jobid);
+        if( pack ) {
+          release_Pack(jobid);
+        }
 
-      _Namelog[i].worker.push_back(wid);
-      _Workerlog[wid].name.push_back(_Name);
-      _Workerlog[wid].rcode.push_back(0);
-      MPI_Send(&retry,1,MPI_INT,wid,450,MPI_COMM_WORLD);
-      MPI_Send(ctable[i],_Csize,MPI_CHAR,wid,500,MPI_COMM_WORLD);
+        // a failed copy waits for the other copy
+        ncopy[jobid] --;
+        if( final[jobid] ) continue;
+        if( ncopy[jobid] > 0 && !(ir[k+1] == 0 && ir[k+2] == 1) ) continue;
+        final[jobid] = 1;
+        nfinal++;
+        write_journal(jobid,ir[k+1],ir[k+2]);
+
+        // jobs with the same line are not run
+        for( int j = _Same[jobid] ; j >= 0 ; j = _Same[j] ) {
+          _Namelog[j].exec = 0;
+          write_journal(j,ir[k+1],ir[k+2]);
+        }
+      }
+      putNotRunRank(wid);
     }
   }
 
-  for( int i = 0 ; i < min(nproc-1,tbsize) ; i++ ) {
-    MPI_Recv(&wid,1,MPI_INT,MPI_ANY_SOURCE,600,MPI_COMM_WORLD,&_Status);
-    MPI_Recv(ir,2,MPI_INT,wid,550,MPI_COMM_WORLD,&_Status);
-    int nameno = atoi(_Workerlog[wid].name.back().c_str());
-    _Namelog[nameno-1].rcode[0][0] = 1;
-    _Namelog[nameno-1].rcode[1][0] = ir[0];
-    _Namelog[nameno-1].rcode[2][0] = ir[1];
-    _Workerlog[wid].rcode.back() = 1;
-    MPI_Send(&retry,1,MPI_INT,wid,450,MPI_COMM_WORLD);
-    MPI_Send(end_tb_flag,_Csize,MPI_CHAR,wid,500,MPI_COMM_WORLD);
+  for( int m = 0 ; m < _Member.size() ; m++ ) {
+    send_job(_Member[m],NULL,0,retry);    // Table list END
   }
 
-  for( int i = 0 ; i < tbsize ; i++ ) delete [] ctable[i];
-  delete [] ctable;
   delete [] param;
 
-  if( tbsize < nproc-1 ) {
-    return 1;
+  // a lost rank can not finalize MPI
+  return eflag;
+}
+
+//============================================================================//
+int Mpidp::chunk_size(const int remain,const int nworker)
+// # of table lines sent at once
+//============================================================================//
+{
+  int nchunk = _Chunk;
+
+  if( _Chunk_mode == 1 ) {      // guided : remain / nworker
+    nchunk = max(_Chunk,(remain+nworker-1)/nworker);
   }
-  else {
-    return 0;
+  else if( _Chunk_mode == 2 ) {   // factoring : remain / (2 nworker) for each batch
+    if( _Chunk_batch == 0 ) {
+      _Chunk_factor = max(_Chunk,(remain+2*nworker-1)/(2*nworker));
+      _Chunk_batch = nworker;
+    }
+    _Chunk_batch --;
+    nchunk = _Chunk_factor;
   }
+
+  return min(nchunk,remain);
 }
 
 //============================================================================//
 int Mpidp::master(const int &nproc)
-// master process (which can respond at the time of an obstacle)
+// master process with retry (-rt > 0)
+//   jobs waiting for the r-th retry are in level[r], and the lowest level is sent first
+//   in JOB ORDER mode new jobs come from the ready queue, and depended jobs
+//   are released only when a job succeeds
 //============================================================================//
 {
   int wid;        // Worker id
-  int retry = 0;      // Retry counter
-  int ir[2];        // 0:RET and 1:FILE flags 
-  int remain_workers = nproc - 1;  // Effective workers
-  int tbsize = _Table_list.size();
-  char end_tb_flag[] = "EndOfTable";  // Table list END flag
+  vector<int> ir;      // job id, RET and FILE flags
+  int tbsize = table_size();
   char *param = new char[_Psize];  // for PARAM data
 
-  // for Table list
-  char **ctable = new char*[tbsize];
-  for( int i = 0 ; i < tbsize ; i++ ) {
-    ctable[i] = new char[_Csize];
-  }
-
   strcpy(param,_Param.c_str());
 
-  // The calculation condition is sent to workers. 
-  for( int i = 1 ; i < nproc ; i++ ) {
+  // The calculation condition is sent to workers.
+  for( int m = 0 ; m < _Member.size() ; m++ ) {
+    int i = _Member[m];
     MPI_Send(&_Psize,1,MPI_INT,i,100,MPI_COMM_WORLD);
     MPI_Send(param,_Psize,MPI_CHAR,i,200,MPI_COMM_WORLD);
     MPI_Send(&_Csize,1,MPI_INT,i,300,MPI_COMM_WORLD);
     MPI_Send(&_Ndata,1,MPI_INT,i,400,MPI_COMM_WORLD);
     MPI_Send(&_Out_option,1,MPI_INT,i,420,MPI_COMM_WORLD);
+    MPI_Send(&_Slot,1,MPI_INT,i,430,MPI_COMM_WORLD);
+    MPI_Send(&_Launcher,1,MPI_INT,i,460,MPI_COMM_WORLD);
   }
 
   _Namelog = new NameLog[tbsize];
   _Workerlog = new WorkerLog[nproc];
 
+  vector<deque<int> > level(_Ntry+1);  // jobs waiting for each retry level
+  vector<char> dup(tbsize,0);  // the same line is run by an earlier job
+  for( int i = 0 ; i < tbsize ; i++ ) {
+    if( _Same[i] >= 0 ) dup[_Same[i]] = 1;
+  }
+
   // JOB management table initialization
   for( int i = 0 ; i < tbsize ; i++ ) {
     sprintf(_Name,"%05d\t\0",i+1);  // Event number
-    strcpy(ctable[i],_Name);
-    strcat(ctable[i],_Table_list[i].c_str());
     _Namelog[i].name = _Name;
     _Namelog[i].exec = 0;    // EXEC flag increment(=retry)
     _Namelog[i].status = 0;    // calculation control flag
+    if( _Done[i] ) {
+      _Namelog[i].status = _Ntry+1;  // skipped (restart)
+    }
   }
-
-  // Worker management table initialization
-  for( int i = 1 ; i < nproc ; i++ ) {
-    _Workerlog[i].failure = 0;    // Initialize failure counter
+  for( int k = 0 ; !_Job_order && k < tbsize ; k++ ) {
+    int i = _Order[k];
+    if( !_Done[i] && !dup[i] ) {
+      level[0].push_back(i);
+    }
   }
 
-  int itry = 0;
-  int jstart = 0;
-  int init_counter = 0;      // initial loop counter
+  // all workers are not running (Worker management table initialization)
+  initNotRunRank();
 
-  while(1) {
-    bool table_remains = false;    // Remains of table check flag
-    int ic;
-
-    for( ic = itry ; ic < _Ntry+1 ; ic++ ) {
-      for( int j = jstart ; j < tbsize ; j++ ) {
-        if( _Namelog[j].exec == ic && _Namelog[j].status < _Ntry+1 ) {
-          table_remains = true;
-          if( init_counter < nproc-1 ) {
-            wid = ++init_counter;
-          }
+  int eflag = 0;
+  int nqueue = 0;      // # of messages not returned
+  int nwait = level[0].size();  // # of jobs in level[]
 
-          retry = _Namelog[j].exec;
-          _Namelog[j].exec ++;
+  while(1) {
+    if( (nwait > 0 || countReadyJobID() > 0) && (wid = getNotRunRank()) != -1 ) {
+      int jobid;
 
-          _Namelog[j].rcode[0].push_back(0);
-          _Namelog[j].rcode[1].push_back(-1);
-          _Namelog[j].rcode[2].push_back(0);
+      if( countReadyJobID() > 0 ) {    // a new job of JOB ORDER mode
+        jobid = getNextReadyJobID();
+        _JobControl[jobid].ready = 0;
+        _JobControl[jobid].run = 1;
+      }
+      else {
+        int r = 0;
+        while( level[r].empty() ) r++;
+        jobid = level[r].front();
+        level[r].pop_front();
+        nwait--;
+      }
 
-          _Namelog[j].worker.push_back(wid);
-          _Workerlog[wid].name.push_back(_Namelog[j].name);
-          _Workerlog[wid].rcode.push_back(0);
-          MPI_Send(&retry,1,MPI_INT,wid,450,MPI_COMM_WORLD);
-          MPI_Send(ctable[j],_Csize,MPI_CHAR,wid,500,MPI_COMM_WORLD);
+      int retry = _Namelog[jobid].exec;
+      _Namelog[jobid].exec ++;
+      dispatch(wid,&jobid,1,retry);
+      nqueue++;
+    }
+    else if( nqueue == 0 ) {
+      if( nwait > 0 || countReadyJobID() > 0 ) {
+        cerr << "[ERROR] All wokers were stoped!!" << endl;
+        eflag = 1;
+      }
+      break;
+    }
+    else {
+      wid = recv_result(ir);
+      if( wid < 0 ) {      // jobs of a lost rank failed
+        deque<int> lost;
+        nqueue -= lost_Worker(_Lost,lost);
+        for( int k = 0 ; k < lost.size() ; k++ ) {
+          nwait += retry_job(lost[k],level);
+        }
+        eflag = 1;
+        continue;
+      }
+      nqueue--;
+
+      int jobid = ir[0];
+      set_Namelog(wid,&ir[0]);
+      write_journal(jobid,ir[1],ir[2]);
+      finish_Workerlog(wid,jobid);
+
+      if( ir[1] == 0 && (ir[2] == 1 || _Out_option == 0) ) {
+        _Namelog[jobid].status = _Ntry+1;
+        update_status(jobid);
+        if( _Job_order ) {
+          _JobControl[jobid].run = 0;
+          _JobControl[jobid].done = 1;
+          resetReadyJobID(jobid);
+        }
+      }
+      else {
+        nwait += retry_job(jobid,level);
+        _Workerlog[wid].failure ++;    // failure counter
+      }
 
-          if( init_counter == nproc-1 ) {
-            break;
-          }
+      // jobs with the same line are not run
+      if( _Namelog[jobid].status > _Ntry ) {
+        for( int j = _Same[jobid] ; j >= 0 ; j = _Same[j] ) {
+          write_journal(j,ir[1],ir[2]);
         }
       }
 
-      if( table_remains ) {
-        break;
+      if( _Workerlog[wid].failure < _Worker_life ) {  // check worker life
+        putNotRunRank(wid);
+      }
+      else if( _Workerlog[wid].queue >= 0 ) {
+        cerr << "[Warning] Worker " << wid << " starts sleeping." << endl;
+        _Workerlog[wid].queue = -1;    // never taken by getNotRunRank()
       }
     }
+  }
 
-    if( !table_remains ) {      // End of calculations
-      if( _Ntry == 0 ) {      // No retry mode
-        MPI_Send(&retry,1,MPI_INT,wid,450,MPI_COMM_WORLD);
-        MPI_Send(end_tb_flag,_Csize,MPI_CHAR,wid,500,MPI_COMM_WORLD);
-
-        for( int i = 0 ; i < min(nproc-2,tbsize-1) ; i++ ) {
-          MPI_Recv(&wid,1,MPI_INT,MPI_ANY_SOURCE,600,MPI_COMM_WORLD,&_Status);
-          MPI_Recv(ir,2,MPI_INT,wid,550,MPI_COMM_WORLD,&_Status);
-
-          int nameno = atoi(_Workerlog[wid].name.back().c_str());
-          _Namelog[nameno-1].rcode[0][0] = 1;
-          _Namelog[nameno-1].rcode[1][0] = ir[0];
-          _Namelog[nameno-1].rcode[2][0] = ir[1];
-
-          _Workerlog[wid].rcode.back() = 1;
-
-          MPI_Send(&retry,1,MPI_INT,wid,450,MPI_COMM_WORLD);
-          MPI_Send(end_tb_flag,_Csize,MPI_CHAR,wid,500,MPI_COMM_WORLD);
-        }
-
-        if( tbsize < nproc-1 ) {
-          for( int i = 0 ; i < tbsize ; i++ ) delete [] ctable[i];
-          delete [] ctable;
-          delete [] param;
-          return 1;
-        }
-        else {
-          for( int i = 0 ; i < tbsize ; i++ ) delete [] ctable[i];
-          delete [] ctable;
-          delete [] param;
-          return 0;
-        }
-      }
-      else {          // Retry mode
-        for( int i = 0 ; i < tbsize ; i++ ) delete [] ctable[i];
-        delete [] ctable;
-        delete [] param;
-        return 1;
+  // jobs not run because a depend job failed
+  if( _Job_order ) {
+    int nblock = 0;
+    for( int i = 0 ; i < tbsize ; i++ ) {
+      if( _Namelog[i].exec == 0 && !_Done[i] ) {
+        nblock ++;
       }
     }
+    if( nblock > 0 ) {
+      cerr << "[WARNING] " << nblock << " jobs were not run because depend jobs failed." << endl;
+    }
+  }
 
-    do {
-      MPI_Recv(&wid,1,MPI_INT,MPI_ANY_SOURCE,600,MPI_COMM_WORLD,&_Status);
-      MPI_Recv(ir,2,MPI_INT,wid,550,MPI_COMM_WORLD,&_Status);
-      int nameno = atoi(_Workerlog[wid].name.back().c_str());
-
-      bool wid_check = false;      // Worker ID check flag
-
-      for( int i = _Namelog[nameno-1].worker.size()-1 ; i >= 0 ; i-- ) {
-        if( _Namelog[nameno-1].worker[i] == wid ) {
-          _Namelog[nameno-1].rcode[0][i] = 1;
-          _Namelog[nameno-1].rcode[1][i] = ir[0];
-          _Namelog[nameno-1].rcode[2][i] = ir[1];
-
-          if( ir[0] == 0 && (ir[1] == 1 || _Out_option == 0) ) {
-            _Namelog[nameno-1].status = _Ntry+1;
-          }
-          else {
-            _Namelog[nameno-1].status ++;
-            _Workerlog[wid].failure ++;    // failure counter
-          }
-
-          wid_check = true;
-          break;
-        }
-      }
-
-      _Workerlog[wid].rcode.back() = 1;
-
-      if( !wid_check ) {
-        cerr << "[ERROR] Woker ID was a mismatch!!" << endl;
-        for( int i = 0 ; i < tbsize ; i++ ) delete [] ctable[i];
-        delete [] ctable;
-        delete [] param;
-        return 1;
-      }
+  for( int m = 0 ; m < _Member.size() ; m++ ) {
+    send_job(_Member[m],NULL,0,0);    // Table list END
+  }
 
-      if( _Workerlog[wid].failure >= _Worker_life ) {  // check worker life
-        cerr << "[Warning] Worker " << wid << " starts sleeping." << endl;
+  delete [] param;
 
-        if( --remain_workers == 0 ) {
-          cerr << "[ERROR] All wokers were stoped!!" << endl;
-          for( int i = 0 ; i < tbsize ; i++ ) delete [] ctable[i];
-          delete [] ctable;
-          delete [] param;
-          return 1;
-        }
+  return eflag;
+}
 
-      }
-    } while( _Workerlog[wid].failure >= _Worker_life );  // check worker life
+//============================================================================//
+int Mpidp::retry_job(const int jobid,vector<deque<int> > &level)
+// a run of the job failed : the job waits for the next retry level
+//   (return 1 : pushed to level[], 0 : no more retry)
+//============================================================================//
+{
+  int r = ++_Namelog[jobid].status;
+  update_status(jobid);
 
-    itry = ic;
+  if( r <= _Ntry ) {
+    level[r].push_back(jobid);
+    return 1;
+  }
 
-    for( int j = jstart ; j < tbsize ; j++ ) {
-      if( _Namelog[j].status > _Ntry ) {
-        jstart = j + 1;
-      }
-      else {
-        break;
-      }
-    }
+  if( _Job_order ) {
+    _JobControl[jobid].run = 0;   // depended jobs are never ready
   }
+  return 0;
 }
 
 //============================================================================//
@@ -697,17 +1179,10 @@ int Mpidp::master1(const int &nproc)
 {
   int wid;        // Worker id
   int retry = 0;      // Retry counter
-  int ir[2];        // 0:RET and 1:FILE flags 
-  int tbsize = _Table_list.size();
-  char end_tb_flag[] = "EndOfTable";  // Table list END flag
+  vector<int> ir;      // job id, RET and FILE flags
+  int tbsize = table_size();
   char *param = new char[_Psize];  // for PARAM data
 
-  // for Table list
-  char **ctable = new char*[tbsize];
-  for( int i = 0 ; i < tbsize ; i++ ) {
-    ctable[i] = new char[_Csize];
-  }
-
   strcpy(param,_Param.c_str());
 
   // The calculation condition is sent to workers. 
@@ -717,91 +1192,79 @@ int Mpidp::master1(const int &nproc)
     MPI_Send(&_Csize,1,MPI_INT,i,300,MPI_COMM_WORLD);
     MPI_Send(&_Ndata,1,MPI_INT,i,400,MPI_COMM_WORLD);
     MPI_Send(&_Out_option,1,MPI_INT,i,420,MPI_COMM_WORLD);
+    MPI_Send(&_Slot,1,MPI_INT,i,430,MPI_COMM_WORLD);
+    MPI_Send(&_Launcher,1,MPI_INT,i,460,MPI_COMM_WORLD);
   }
 
   _Namelog = new NameLog[tbsize];
   _Workerlog = new WorkerLog[nproc];
 
-  int nsend = 0;
-  int nrecv = 0;
-  while(1) {
-
-    int jobid = getNextReadyJobID();
+  // all workers are not running
+  initNotRunRank();
 
-    if( jobid != -1 ) {
-      sprintf(_Name,"%05d\t\0",jobid+1);  // Event number
-      strcpy(ctable[jobid],_Name);
-      strcat(ctable[jobid],_Table_list[jobid].c_str());
-      _Namelog[jobid].name = _Name;
-      _Namelog[jobid].exec = 1;    // EXEC flag = 1 (fixed)
+  // finished jobs of a previous run
+  for( int i = 0 ; i < tbsize ; i++ ) {
+    if( _Done[i] ) {
+      sprintf(_Name,"%05d\t\0",i+1);  // Event number
+      _Namelog[i].name = _Name;
+      _Namelog[i].exec = 0;    // skipped (restart)
+    }
+  }
 
-      _Namelog[jobid].rcode[0].push_back(0);
-      _Namelog[jobid].rcode[1].push_back(-1);
-      _Namelog[jobid].rcode[2].push_back(0);
+  int eflag = 0;
+  int nrecv = _Ndone;
+  int nqueue = 0;      // # of messages not returned
+  while( nrecv < tbsize ) {
+    int jobid = -1;
 
-      if( nsend < nproc-1 ) {
-        _Namelog[jobid].worker.push_back(nsend+1);
-        _Workerlog[nsend+1].name.push_back(_Name);
-        _Workerlog[nsend+1].rcode.push_back(0);
-        _Workerlog[nsend+1].run = 1;
-        MPI_Send(&retry,1,MPI_INT,nsend+1,450,MPI_COMM_WORLD);
-        MPI_Send(ctable[jobid],_Csize,MPI_CHAR,nsend+1,500,MPI_COMM_WORLD);
+    if( countReadyJobID() > 0 && (wid = getNotRunRank()) != -1 ) {
+      jobid = getNextReadyJobID();
 
-        _JobControl[jobid].ready = 0;
-        _JobControl[jobid].run = 1;
-        nsend++;
+      if( _Namelog[jobid].worker.empty() ) {
+        sprintf(_Name,"%05d\t\0",jobid+1);  // Event number
+        _Namelog[jobid].name = _Name;
+        _Namelog[jobid].exec = 1;    // EXEC flag = 1 (+1 when a rank is lost)
       }
-      else {
-
-        wid = getNotRunRank(nproc);
 
-        if( wid != -1 ) {
-          _Namelog[jobid].worker.push_back(wid);
-          _Workerlog[wid].name.push_back(_Name);
-          _Workerlog[wid].rcode.push_back(0);
-          _Workerlog[wid].run = 1;
-          MPI_Send(&retry,1,MPI_INT,wid,450,MPI_COMM_WORLD);
-          MPI_Send(ctable[jobid],_Csize,MPI_CHAR,wid,500,MPI_COMM_WORLD);
+      // a job of a lost rank writes outfile.<# of runs>
+      dispatch(wid,&jobid,1,_Namelog[jobid].exec-1);
+      nqueue++;
 
-          _JobControl[jobid].ready = 0;
-          _JobControl[jobid].run = 1;
-          nsend++;
-        }
-        else {
-          MPI_Recv(&wid,1,MPI_INT,MPI_ANY_SOURCE,600,MPI_COMM_WORLD,&_Status);
-          MPI_Recv(ir,2,MPI_INT,wid,550,MPI_COMM_WORLD,&_Status);
-          nrecv++;
-          int nameno = atoi(_Workerlog[wid].name.back().c_str());
-          int jobid0 = nameno - 1;
-          _Namelog[jobid0].rcode[0][0] = 1;
-          _Namelog[jobid0].rcode[1][0] = ir[0];
-          _Namelog[jobid0].rcode[2][0] = ir[1];
-
-          _Workerlog[wid].rcode.back() = 1;
-          _Workerlog[wid].run = 0;
-
-          _JobControl[jobid0].ready = 0;
-          _JobControl[jobid0].run = 0;
-          _JobControl[jobid0].done = 1;
-          resetReadyJobID(jobid0);
-#ifdef DEBUG_LOG
-          writeJobControl();
-#endif
-        }
-      }
+      _JobControl[jobid].ready = 0;
+      _JobControl[jobid].run = 1;
+    }
+    else if( nqueue == 0 && _Nlost == _Member.size() ) {
+      cerr << "[ERROR] All workers were lost!!" << endl;
+      eflag = 1;
+      break;
+    }
+    else if( nqueue == 0 ) {
+      // nothing is running, but no job is ready
+      cerr << "[ERROR] JOB table has circular dependencies!!" << endl;
+      eflag = 1;
+      break;
     }
     else {
-      MPI_Recv(&wid,1,MPI_INT,MPI_ANY_SOURCE,600,MPI_COMM_WORLD,&_Status);
-      MPI_Recv(ir,2,MPI_INT,wid,550,MPI_COMM_WORLD,&_Status);
+      wid = recv_result(ir);
+      if( wid < 0 ) {      // jobs of a lost rank are ready again
+        deque<int> requeue;
+        nqueue -= lost_Worker(_Lost,requeue);
+        for( int k = 0 ; k < requeue.size() ; k++ ) {
+          _Namelog[requeue[k]].exec ++;
+          _JobControl[requeue[k]].run = 0;
+          pushReadyJobID(requeue[k]);
+        }
+        eflag = 1;
+        continue;
+      }
       nrecv++;
-      int nameno = atoi(_Workerlog[wid].name.back().c_str());
-      int jobid0 = nameno - 1;
-      _Namelog[jobid0].rcode[0][0] = 1;
-      _Namelog[jobid0].rcode[1][0] = ir[0];
-      _Namelog[jobid0].rcode[2][0] = ir[1];
+      nqueue--;
+      int jobid0 = ir[0];
+      set_Namelog(wid,&ir[0]);
+      write_journal(jobid0,ir[1],ir[2]);
 
-      _Workerlog[wid].rcode.back() = 1;
-      _Workerlog[wid].run = 0;
+      finish_Workerlog(wid,jobid0);
+      putNotRunRank(wid);
 
       _JobControl[jobid0].ready = 0;
       _JobControl[jobid0].run = 0;
@@ -810,27 +1273,18 @@ int Mpidp::master1(const int &nproc)
 #ifdef DEBUG_LOG
       writeJobControl();
 #endif
-
-      if( nrecv == tbsize ) break;
     }
   }
 
   // finalization 
   for( int i = 0 ; i < nproc-1 ; i++ ) {
-    MPI_Send(&retry,1,MPI_INT,i+1,450,MPI_COMM_WORLD);
-    MPI_Send(end_tb_flag,_Csize,MPI_CHAR,i+1,500,MPI_COMM_WORLD);
+    send_job(i+1,NULL,0,retry);    // Table list END
   }
 
-  for( int i = 0 ; i < tbsize ; i++ ) delete [] ctable[i];
-  delete [] ctable;
   delete [] param;
 
-  if( tbsize < nproc-1 ) {
-    return 1;
-  }
-  else {
-    return 0;
-  }
+  // a lost rank can not finalize MPI
+  return eflag;
 }
 
 #ifndef SYSTEMCALL
@@ -841,13 +1295,13 @@ void Mpidp::worker(int &myid,char *hostname,int argc,char *argv[])
 {
   int    argc2;    // # of mpidp comand line parameters
   int    wargc;    // # of application command line parameters
-  int    retry;
-  int    ir[2];
+  deque<JobMessage> jobqueue;    // received messages
+  vector<int>  ir;      // job id, RET and FILE flags of each line
   struct stat  buf;
 
-  MPI_Recv(&_Psize,1,MPI_INT,0,100,MPI_COMM_WORLD,&_Status);
+  MPI_Recv(&_Psize,1,MPI_INT,_Parent,100,MPI_COMM_WORLD,&_Status);
   char *param = new char[_Psize];
-  MPI_Recv(param,_Psize,MPI_CHAR,0,200,MPI_COMM_WORLD,&_Status);
+  MPI_Recv(param,_Psize,MPI_CHAR,_Parent,200,MPI_COMM_WORLD,&_Status);
   _Param = param;
 
   if( !strncmp(param,"MPIDP",5) ) {
@@ -855,11 +1309,11 @@ void Mpidp::worker(int &myid,char *hostname,int argc,char *argv[])
     exit(1);
   }
 
-  MPI_Recv(&_Csize,1,MPI_INT,0,300,MPI_COMM_WORLD,&_Status);
-  MPI_Recv(&_Ndata,1,MPI_INT,0,400,MPI_COMM_WORLD,&_Status);
-  MPI_Recv(&_Out_option,1,MPI_INT,0,420,MPI_COMM_WORLD,&_Status);
-
-  char *ctable = new char[_Csize];
+  MPI_Recv(&_Csize,1,MPI_INT,_Parent,300,MPI_COMM_WORLD,&_Status);
+  MPI_Recv(&_Ndata,1,MPI_INT,_Parent,400,MPI_COMM_WORLD,&_Status);
+  MPI_Recv(&_Out_option,1,MPI_INT,_Parent,420,MPI_COMM_WORLD,&_Status);
+  MPI_Recv(&_Slot,1,MPI_INT,_Parent,430,MPI_COMM_WORLD,&_Status);
+  MPI_Recv(&_Launcher,1,MPI_INT,_Parent,460,MPI_COMM_WORLD,&_Status);
 
   // Correction of a bug
   int arglen = max(_Csize,_Psize);
@@ -879,54 +1333,69 @@ void Mpidp::worker(int &myid,char *hostname,int argc,char *argv[])
   }
 
   argc2 = argument(argc,argv,wargv);
+  worker_option(argc,argv);
+  _Beat = MPI_Wtime();
 
   while(1) {
-    MPI_Recv(&retry,1,MPI_INT,0,450,MPI_COMM_WORLD,&_Status);
-    MPI_Recv(ctable,_Csize,MPI_CHAR,0,500,MPI_COMM_WORLD,&_Status);
-    if( !strncmp(ctable,"EndOfTable",10) ) break;  // Table End flag
-
-    // Preparation using function call
-    wargc = for_worker(retry,ctable,argc2,wargv);
-    //    cout << _Name << " : " << hostname << "(" << myid << ")" << endl;
-
-    /* for test
-    if( _Out_option ) {
-      cout << "(int)MPI_Wtime() = " << (int)MPI_Wtime() << endl;
-      if( int(MPI_Wtime())%20 == 0 ) {
-        cout << "Worker " << myid << " starts sleeping.\n";
-        sleep(100000);
+    recv_job(jobqueue);
+    JobMessage &job = jobqueue.front();
+    int njob = job.jobid.size();
+    if( njob == 0 ) break;  // Table End flag
+
+    // heartbeats are sent between function calls (-hb)
+    //   a call longer than 3 heartbeats is taken as a lost rank
+    ir.resize(RESULT_SIZE*njob);
+    for( int k = 0 ; k < njob ; k++ ) {
+      send_heartbeat(1);
+      sprintf(_Name,"%05d",job.jobid[k]+1);  // Event number
+      ir[RESULT_SIZE*k] = job.jobid[k];
+
+      // Preparation using function call
+      wargc = for_worker(job.retry,&job.ctable[job.offset[k]],argc2,wargv);
+      //    cout << _Name << " : " << hostname << "(" << myid << ")" << endl;
+
+      // CPU time of the application is taken from this process
+      struct rusage usage0, usage1;
+      double start = MPI_Wtime();
+      getrusage(RUSAGE_SELF,&usage0);
+
+      try {
+        throw application(wargc,wargv);  // application's main function
+      }
+      catch(int e) {
+        ir[RESULT_SIZE*k+1] = e;
+      }
+      catch(char *e) {
+        cerr << "[ERROR] [application] exception : " << e << endl;
+        ir[RESULT_SIZE*k+1] = -1;
       }
-    }
-    */
-
-    try {
-      throw application(wargc,wargv);  // application's main function
-    }
-    catch(int e) {
-      ir[0] = e;
-    }
-    catch(char *e) {
-      cerr << "[ERROR] [application] exception : " << e << endl;
-      ir[0] = -1;
-    }
 
-    if( _Out_option ) {        // check the output file
-      ir[1] = stat(_Out_file.c_str(),&buf);
-      if( ir[1] == 0 ) {
-        ir[1] = 1;
+      getrusage(RUSAGE_SELF,&usage1);
+      ir[RESULT_SIZE*k+3] = (int)((MPI_Wtime() - start) * 1000.0);
+      ir[RESULT_SIZE*k+4] = (usage1.ru_utime.tv_sec - usage0.ru_utime.tv_sec)*1000
+                          + (usage1.ru_utime.tv_usec - usage0.ru_utime.tv_usec)/1000;
+      ir[RESULT_SIZE*k+5] = (usage1.ru_stime.tv_sec - usage0.ru_stime.tv_sec)*1000
+                          + (usage1.ru_stime.tv_usec - usage0.ru_stime.tv_usec)/1000;
+      ir[RESULT_SIZE*k+6] = usage1.ru_maxrss;    // peak of this process
+      ir[RESULT_SIZE*k+7] = 0;                   // no result cache
+
+      if( _Out_option ) {        // check the output file
+        ir[RESULT_SIZE*k+2] = stat(_Out_file.c_str(),&buf);
+        if( ir[RESULT_SIZE*k+2] == 0 ) {
+          ir[RESULT_SIZE*k+2] = 1;
+        }
+      }
+      else {
+        ir[RESULT_SIZE*k+2] = 0;
       }
-    }
-    else {
-      ir[1] = 0;
     }
 
-    MPI_Send(&myid,1,MPI_INT,0,600,MPI_COMM_WORLD);  // Send id
-    MPI_Send(ir,2,MPI_INT,0,550,MPI_COMM_WORLD);
+    MPI_Send(&ir[0],RESULT_SIZE*njob,MPI_INT,_Parent,600,MPI_COMM_WORLD);
+    jobqueue.pop_front();
   }
 
   for( int i = 0 ; i < nwargv ; i++ ) delete [] wargv[i];
   delete [] wargv;
-  delete [] ctable;
   delete [] param;
 
   return;
@@ -940,20 +1409,29 @@ void Mpidp::worker(int &myid,char *hostname,int argc,char *argv[])
 {
   string  main_argv;    // mpidp command line
   string  argv_joblist;    // system call command line
-  int    retry;
-  int    ir[2];
+  deque<JobMessage> jobqueue;    // received messages
+  deque<vector<int> > result;    // job id, RET and FILE flags of each message
+  deque<int>   remain;     // # of lines not finished in each message
   struct stat   buf;
+  int first = 0;        // serial number of jobqueue.front()
+  int nextm = 0;        // serial number of message with the next line
+  int nextl = 0;        // next line in the message
+  int nrun = 0;         // # of running jobs
+  int end = 0;          // Table list END was received
 
-  MPI_Recv(&_Psize,1,MPI_INT,0,100,MPI_COMM_WORLD,&_Status);
+  MPI_Recv(&_Psize,1,MPI_INT,_Parent,100,MPI_COMM_WORLD,&_Status);
   char *param = new char[_Psize];
-  MPI_Recv(param,_Psize,MPI_CHAR,0,200,MPI_COMM_WORLD,&_Status);
+  MPI_Recv(param,_Psize,MPI_CHAR,_Parent,200,MPI_COMM_WORLD,&_Status);
   _Param = param;
 
-  MPI_Recv(&_Csize,1,MPI_INT,0,300,MPI_COMM_WORLD,&_Status);
-  MPI_Recv(&_Ndata,1,MPI_INT,0,400,MPI_COMM_WORLD,&_Status);
-  MPI_Recv(&_Out_option,1,MPI_INT,0,420,MPI_COMM_WORLD,&_Status);
+  MPI_Recv(&_Csize,1,MPI_INT,_Parent,300,MPI_COMM_WORLD,&_Status);
+  MPI_Recv(&_Ndata,1,MPI_INT,_Parent,400,MPI_COMM_WORLD,&_Status);
+  MPI_Recv(&_Out_option,1,MPI_INT,_Parent,420,MPI_COMM_WORLD,&_Status);
+  MPI_Recv(&_Slot,1,MPI_INT,_Parent,430,MPI_COMM_WORLD,&_Status);
+  MPI_Recv(&_Launcher,1,MPI_INT,_Parent,460,MPI_COMM_WORLD,&_Status);
 
   int ia = argument(argc,argv,main_argv);
+  worker_option(argc,argv);
 
   if( ia == 0 && !strncmp(param,"MPIDP",5) ) {
     cerr << "[ERROR] [PARAM=] was not found in table file!!" << endl;
@@ -965,50 +1443,183 @@ void Mpidp::worker(int &myid,char *hostname,int argc,char *argv[])
     }
   }
 
-  char *ctable = new char[_Csize];
+  vector<JobSlot> slot(_Slot);
+  for( int s = 0 ; s < _Slot ; s++ ) {
+    slot[s].pid = 0;
+  }
+  _Beat = MPI_Wtime();
+
+  // SIGCHLD is kept pending, and taken by sigtimedwait() (jobs get an empty mask)
+  sigset_t sigchld;
+  sigemptyset(&sigchld);
+  sigaddset(&sigchld,SIGCHLD);
+  sigprocmask(SIG_BLOCK,&sigchld,NULL);
+
+  while( !end || !jobqueue.empty() ) {
+    // wait for a message if nothing is running, and take all arrived messages
+    if( !end ) {
+      recv_job(jobqueue);
+      while( result.size() < jobqueue.size() ) {
+        int njob = jobqueue[result.size()].jobid.size();
+        if( njob == 0 ) {    // Table End flag
+          jobqueue.pop_back();
+          end = 1;
+          break;
+        }
+        result.push_back(vector<int>(RESULT_SIZE*njob,0));
+        remain.push_back(njob);
+      }
+    }
+    send_heartbeat(!jobqueue.empty());
+
+    // jobs left at Table list END are backup copies which lost (-bk)
+    if( end && !jobqueue.empty() ) {
+      int status;
+      for( int s = 0 ; s < _Slot ; s++ ) {
+        if( slot[s].pid != 0 ) {
+          kill(-slot[s].pid,SIGKILL);    // the process group of the job
+          waitpid(slot[s].pid,&status,0);
+        }
+      }
+      break;
+    }
+
+    // lines are started on free job slots
+    while( nrun < _Slot && nextm-first < jobqueue.size() ) {
+      JobMessage &job = jobqueue[nextm-first];
+      int m = nextm;
+      int l = nextl;
+      int *ir = &result[m-first][RESULT_SIZE*l];
+
+      send_heartbeat(1);
+      if( ++nextl == job.jobid.size() ) {
+        nextm++;
+        nextl = 0;
+      }
 
-  while(1) {
-    MPI_Recv(&retry,1,MPI_INT,0,450,MPI_COMM_WORLD,&_Status);
-    MPI_Recv(ctable,_Csize,MPI_CHAR,0,500,MPI_COMM_WORLD,&_Status);
-    if( !strncmp(ctable,"EndOfTable",10) ) break;  // Table End flag
+      sprintf(_Name,"%05d",job.jobid[l]+1);  // Event number
+      ir[0] = job.jobid[l];
+
+      argv_joblist = main_argv;
+      if( ia == 0 ) {
+        argv_joblist += ' ';
+        argv_joblist += _Param;
+      }
+
+      // Preparation using system call
+      string line = &job.ctable[job.offset[l]];
+      for_worker(job.retry,&job.ctable[job.offset[l]],ia,argv_joblist);
+      //    cout << _Name << " : " << hostname << "(" << myid << ")" << endl;
+
+      // the same command line with the same inputs was run before
+      string key;
+      if( !_Cache_dir.empty() && !_Out_file.empty() ) {
+        key = cache_key(argv_joblist,line);
+        if( read_cache(key,_Out_file,ir[1]) ) {
+          ir[2] = (stat(_Out_file.c_str(),&buf) == 0) ? 1 : -1;
+          ir[7] = 1;
+          remain[m-first] --;
+          continue;
+        }
+      }
+
+      int s = 0;
+      while( slot[s].pid != 0 ) s++;
 
-    argv_joblist = main_argv;
-    if( ia == 0 ) {
-      argv_joblist += ' ';
-      argv_joblist += _Param;
+      slot[s].pid = spawn_job(argv_joblist);  // child process for application
+      slot[s].msg = m;
+      slot[s].line = l;
+      slot[s].out_file = _Out_file;
+      slot[s].key = key;
+      slot[s].start = MPI_Wtime();
+      nrun++;
     }
 
-    // Preparation using system call
-    for_worker(retry,ctable,ia,argv_joblist);
-    //    cout << _Name << " : " << hostname << "(" << myid << ")" << endl;
+    // a job is finished (free job slots also wait for a message from master)
+    //   the worker sleeps in sigtimedwait() until a job exits, the next
+    //   heartbeat (-hb) or the next look for a message (free slots)
+    //   Table list END may stop a backup copy which lost (-bk)
+    //   CPU time and max RSS of the job are taken by wait4()
+    int status, flag;
+    int poll = (nrun < _Slot || _Backup) && !end;
+    struct rusage usage;
+    pid_t pid = 0;
+    double nap = 1.0e-5;    // look for a message (10 usec., doubled up to 1 msec.)
+    while( nrun > 0 && (pid = wait4(-1,&status,(poll || _Heartbeat > 0.0) ? WNOHANG : 0,&usage)) == 0 ) {
+      if( poll ) {
+        MPI_Iprobe(_Parent,500,MPI_COMM_WORLD,&flag,&_Status);
+        if( flag ) break;
+      }
+      send_heartbeat(1);
 
-    /* for test
-    if( _Out_option ) {
-      cout << "(int)MPI_Wtime() = " << (int)MPI_Wtime() << endl;
-      if( int(MPI_Wtime())%20 == 0 ) {
-        cout << "Worker " << myid << " starts sleeping.\n";
-        sleep(100000);
+      double wait = poll ? nap : _Heartbeat;
+      if( _Heartbeat > 0.0 ) {
+        wait = min(wait,max(_Beat + _Heartbeat - MPI_Wtime(),0.0));
       }
+      struct timespec timeout;
+      timeout.tv_sec = (time_t)wait;
+      timeout.tv_nsec = (long)((wait - timeout.tv_sec) * 1.0e9);
+      sigtimedwait(&sigchld,NULL,&timeout);
+      nap = min(2.0 * nap,1.0e-3);
     }
-    */
 
-    ir[0] = system(argv_joblist.c_str());  // system call for application
+    if( pid != 0 ) {
+      int s = 0;
+      while( s < _Slot && slot[s].pid != pid ) s++;
+      if( pid < 0 || s == _Slot ) {
+        cerr << "[ERROR] Child process of worker " << myid << " was lost!!" << endl;
+        MPI_Abort(MPI_COMM_WORLD,1);
+        exit(1);
+      }
 
-    if( _Out_option ) {        // check the output file
-      ir[1] = stat(_Out_file.c_str(),&buf);
-      if( ir[1] == 0 ) {
-        ir[1] = 1;
+      int *ir = &result[slot[s].msg-first][RESULT_SIZE*slot[s].line];
+      ir[3] = (int)((MPI_Wtime() - slot[s].start) * 1000.0);
+      ir[4] = usage.ru_utime.tv_sec*1000 + usage.ru_utime.tv_usec/1000;
+      ir[5] = usage.ru_stime.tv_sec*1000 + usage.ru_stime.tv_usec/1000;
+      ir[6] = usage.ru_maxrss;
+      // exit status, or 128 + signal number as the shell reports it
+      if( WIFEXITED(status) ) {
+        ir[1] = WEXITSTATUS(status);
       }
-    }
-    else {
-      ir[1] = 0;
+      else if( WIFSIGNALED(status) ) {
+        ir[1] = 128 + WTERMSIG(status);
+        cerr << "[WARNING] Job " << ir[0]+1
+             << " was killed by signal " << WTERMSIG(status) << "." << endl;
+      }
+      else {
+        ir[1] = -1;
+      }
+
+      if( _Out_option ) {        // check the output file
+        ir[2] = stat(slot[s].out_file.c_str(),&buf);
+        if( ir[2] == 0 ) {
+          ir[2] = 1;
+        }
+      }
+      else {
+        ir[2] = 0;
+      }
+
+      // only successful results are cached
+      if( !slot[s].key.empty() && ir[1] == 0 && ir[2] == 1 ) {
+        write_cache(slot[s].key,slot[s].out_file,ir[1]);
+      }
+
+      remain[slot[s].msg-first] --;
+      slot[s].pid = 0;
+      nrun--;
     }
 
-    MPI_Send(&myid,1,MPI_INT,0,600,MPI_COMM_WORLD);  // Send id
-    MPI_Send(ir,2,MPI_INT,0,550,MPI_COMM_WORLD);
+    // results are returned in the order of messages
+    while( !remain.empty() && remain.front() == 0 ) {
+      MPI_Send(&result.front()[0],result.front().size(),MPI_INT,_Parent,600,MPI_COMM_WORLD);
+      jobqueue.pop_front();
+      result.pop_front();
+      remain.pop_front();
+      first++;
+    }
   }
 
-  delete [] ctable;
   delete [] param;
 
   return;
@@ -1016,317 +1627,2776 @@ void Mpidp::worker(int &myid,char *hostname,int argc,char *argv[])
 #endif
 
 //============================================================================//
-int Mpidp::argument(int argc,char *argv[],char **wargv)
-// Procedure of options for function call version
+void Mpidp::submaster(int &myid,int argc,char *argv[])
+// sub-master process : JOB blocks from master are run by node-local workers
+//   one result message is returned to master for each block
 //============================================================================//
 {
-  int ic = 0;
+  int nproc;
+  int lsched[2];        // chunk size and prefetch depth on local workers
+  vector<int> ir;      // job id, RET and FILE flags of each line
+  deque<JobMessage>    block;   // blocks not returned yet
+  deque<vector<int> >  result;  // results of each block
+  deque<int>           remain;  // # of lines not returned in each block
+  int first = 0;        // serial number of block.front()
+  int nextb = 0;        // serial number of block with the next line
+  int nextl = 0;        // next line in the block
+  int nqueue = 0;       // # of messages not returned
+  int end = 0;          // Table list END was received
 
-  for( int i = 0 ; i < argc ; i++ ) {
-    if( !strncmp(argv[i],"-tb",3) ||
-        !strncmp(argv[i],"-ot",3) ||
-        !strncmp(argv[i],"-rt",3) ||
-        !strncmp(argv[i],"-wl",3) ||
-        !strncmp(argv[i],"-jo",3) ||
-        !strncmp(argv[i],"-lg",3) ) {
-      i++;
+  MPI_Comm_size(MPI_COMM_WORLD,&nproc);
+
+  // The calculation condition is forwarded to local workers.
+  MPI_Recv(&_Psize,1,MPI_INT,_Parent,100,MPI_COMM_WORLD,&_Status);
+  char *param = new char[_Psize];
+  MPI_Recv(param,_Psize,MPI_CHAR,_Parent,200,MPI_COMM_WORLD,&_Status);
+  MPI_Recv(&_Csize,1,MPI_INT,_Parent,300,MPI_COMM_WORLD,&_Status);
+  MPI_Recv(&_Ndata,1,MPI_INT,_Parent,400,MPI_COMM_WORLD,&_Status);
+  MPI_Recv(&_Out_option,1,MPI_INT,_Parent,420,MPI_COMM_WORLD,&_Status);
+  MPI_Recv(&_Slot,1,MPI_INT,_Parent,430,MPI_COMM_WORLD,&_Status);
+  MPI_Recv(&_Launcher,1,MPI_INT,_Parent,460,MPI_COMM_WORLD,&_Status);
+  MPI_Recv(lsched,2,MPI_INT,_Parent,440,MPI_COMM_WORLD,&_Status);
+  _Chunk = lsched[0];
+  _Prefetch = lsched[1];
+  worker_option(argc,argv);
+
+  for( int m = 0 ; m < _Member.size() ; m++ ) {
+    int i = _Member[m];
+    MPI_Send(&_Psize,1,MPI_INT,i,100,MPI_COMM_WORLD);
+    MPI_Send(param,_Psize,MPI_CHAR,i,200,MPI_COMM_WORLD);
+    MPI_Send(&_Csize,1,MPI_INT,i,300,MPI_COMM_WORLD);
+    MPI_Send(&_Ndata,1,MPI_INT,i,400,MPI_COMM_WORLD);
+    MPI_Send(&_Out_option,1,MPI_INT,i,420,MPI_COMM_WORLD);
+    MPI_Send(&_Slot,1,MPI_INT,i,430,MPI_COMM_WORLD);
+    MPI_Send(&_Launcher,1,MPI_INT,i,460,MPI_COMM_WORLD);
+  }
+
+  _Workerlog = new WorkerLog[nproc];
+  initNotRunRank();
+  vector<deque<int> > sent(nproc);  // serial numbers of blocks sent to each worker
+  _Beat = MPI_Wtime();
+
+  // blocks left at Table list END are backup copies which lost (-bk)
+  while( !end ) {
+    int wid;
+
+    // lines are sent to free local workers
+    while( nextb-first < block.size() && (wid = getNotRunRank()) != -1 ) {
+      JobMessage &job = block[nextb-first];
+      int nline = min(_Chunk,(int)job.jobid.size()-nextl);
+      vector<const char *> line(nline);
+      vector<int> len(nline);
+
+      for( int k = 0 ; k < nline ; k++ ) {
+        int l = nextl + k;
+        int tail = (l+1 < job.offset.size()) ? job.offset[l+1] : job.ctable.size();
+        line[k] = &job.ctable[job.offset[l]];
+        len[k] = tail - job.offset[l] - 1;
+      }
+      send_job(wid,job.retry,nline,&job.jobid[nextl],&line[0],&len[0]);
+      if( sent[wid].empty() ) {
+        _Workerlog[wid].heard = MPI_Wtime();
+      }
+      sent[wid].push_back(nextb);
+      nqueue++;
+
+      nextl += nline;
+      if( nextl == job.jobid.size() ) {
+        nextb++;
+        nextl = 0;
+      }
     }
-    else {
-      strcpy(wargv[ic++],argv[i]);
+
+    // a block, results or a heartbeat of a local worker
+    MPI_Probe(MPI_ANY_SOURCE,MPI_ANY_TAG,MPI_COMM_WORLD,&_Status);
+
+    if( _Status.MPI_TAG == 700 ) {   // a heartbeat from a local worker
+      int n;
+      MPI_Recv(&n,1,MPI_INT,_Status.MPI_SOURCE,700,MPI_COMM_WORLD,&_Status);
+      _Workerlog[_Status.MPI_SOURCE].heard = MPI_Wtime();
+    }
+    else if( _Status.MPI_TAG == 500 ) {   // a block from master
+      JobMessage job;
+      recv_job(job);
+      if( job.jobid.empty() ) {
+        end = 1;      // Table list END
+      }
+      else {
+        remain.push_back(job.jobid.size());
+        result.push_back(vector<int>());
+        block.push_back(job);
+      }
+    }
+    else {                           // results from a local worker
+      wid = recv_result(ir);
+      putNotRunRank(wid);
+      nqueue--;
+
+      int b = sent[wid].front() - first;
+      sent[wid].pop_front();
+      result[b].insert(result[b].end(),ir.begin(),ir.end());
+      remain[b] -= ir.size()/RESULT_SIZE;
+      if( remain[b] == 0 ) {
+        MPI_Send(&result[b][0],result[b].size(),MPI_INT,_Parent,600,MPI_COMM_WORLD);
+      }
+
+      while( !remain.empty() && remain.front() == 0 ) {
+        block.pop_front();
+        result.pop_front();
+        remain.pop_front();
+        first++;
+      }
+    }
+
+    // a heartbeat is sent to master only while every busy local worker has
+    //   sent one within _Heartbeat, so that master takes a node with a silent
+    //   worker as lost and its blocks are sent again (-hb)
+    if( _Heartbeat > 0.0 && !block.empty() && MPI_Wtime() - _Beat >= _Heartbeat ) {
+      double now = MPI_Wtime();
+      int alive = 1;
+      for( int m = 0 ; m < _Member.size() ; m++ ) {
+        int i = _Member[m];
+        if( !sent[i].empty() && now - _Workerlog[i].heard > _Heartbeat ) {
+          alive = 0;
+        }
+      }
+      if( alive ) {
+        MPI_Send(&nqueue,1,MPI_INT,_Parent,700,MPI_COMM_WORLD);
+        _Beat = now;
+      }
     }
   }
 
-  return ic;
+  for( int m = 0 ; m < _Member.size() ; m++ ) {
+    send_job(_Member[m],NULL,0,0);    // Table list END
+  }
+
+  delete [] _Workerlog;
+  delete [] param;
+
+  return;
 }
 
 //============================================================================//
-int Mpidp::argument(int argc,char *argv[],string &main_argv)
-// Procedure of options for system call version
+int Mpidp::mpidp_option(const char *arg)
+// MPIDP option with a value (1) or not (0)
 //============================================================================//
 {
-  int iflag = 1;
-
-  for( int i = 1 ; i < argc ; i++ ) {
-    if( !strncmp(argv[i],"-pg",3) ) {
-      main_argv = argv[++i];
-      iflag = 0;
-    }
-    else if( !strncmp(argv[i],"-tb",3) ||
-             !strncmp(argv[i],"-ot",3) ||
-             !strncmp(argv[i],"-rt",3) ||
-             !strncmp(argv[i],"-wl",3) ||
-             !strncmp(argv[i],"-jo",3) ||
-             !strncmp(argv[i],"-lg",3) ) {
-      i++;
+  // options of the first version match by prefix, and later ones exactly
+  //   (application arguments such as -check or -host are not taken)
+  const char *prefix[] = { "-tb", "-ot", "-rt", "-wl", "-jo", "-lg", NULL };
+  const char *option[] = { "-pr", "-cc", "-ck", "-cm", "-pf", "-sl",
+                           "-ln", "-hm", "-jn", "-rs", "-mk", "-ic",
+                           "-ch", "-hb", "-dl", "-bk", "-tr", "-st",
+                           "-si", "-hs", "-hc", "-hd", "-rc", "-rm",
+                           "-nc", "-nm", "-cp", NULL };
+
+  for( int i = 0 ; prefix[i] != NULL ; i++ ) {
+    if( !strncmp(arg,prefix[i],3) ) {
+      return 1;
     }
-    else {
-      main_argv += ' ';
-      main_argv += argv[i];
+  }
+  for( int i = 0 ; option[i] != NULL ; i++ ) {
+    if( !strcmp(arg,option[i]) ) {
+      return 1;
     }
   }
 
-  return iflag;
+  return 0;
 }
 
 //============================================================================//
-int Mpidp::for_worker(int &retry,char *ctable,int argc2,char **wargv)
-// Preparation using function call version by workers
+void Mpidp::send_job(const int wid,const int *jobid,const int njob,const int retry)
+// send table lines to a worker in one message (njob = 0 : Table list END)
 //============================================================================//
 {
-  string  position;
-  string  tstock;
-  string  sparam = _Param;
-  char    tag[5], *elem;
-  char    *saveptr;
-
-  strcpy(_Name,strtok_r(ctable,"\t",&saveptr));
-
-  for( int i = 0 ; i < _Ndata-1 ; i++ ) {
-    sprintf(tag,"$%d",i+1);
-    position = tag;
-    tstock = strtok_r(NULL,"\t",&saveptr);
-
-    if( _Out_option == i+1 ) {
-      if( retry ) {
-        sprintf(tag,"%d",retry);
-        tstock += ".";
-        tstock += tag;
-      }
-      _Out_file = tstock;
-    }
+  vector<const char *> line(njob);
+  vector<int> len(njob);
 
-    // character is replaced
-    sparam = replace_pattern(sparam,position,tstock);
+  for( int k = 0 ; k < njob ; k++ ) {
+    line[k] = table_ptr(jobid[k]);
+    len[k] = table_len(jobid[k]);
   }
 
-  char *param = new char[sparam.size()+1];
-  strcpy(param,sparam.c_str());
-  strcpy(wargv[argc2++],strtok_r(param," ",&saveptr));
+  send_job(wid,retry,njob,jobid,njob ? &line[0] : NULL,njob ? &len[0] : NULL);
+}
 
-  while( (elem = strtok_r(NULL," ",&saveptr)) ) {
-    strcpy(wargv[argc2++],elem);
+//============================================================================//
+void Mpidp::send_job(const int wid,const int retry,const int njob,const int *jobid,
+                     const char * const *line,const int *len)
+// send jobs to a worker in one message
+//   [retry][njob] + njob x ( [job id][length][table line] )
+//============================================================================//
+{
+  int size, isize, csize;
+  int position = 0;
+  int head[2];
+
+  MPI_Pack_size(2,MPI_INT,MPI_COMM_WORLD,&isize);
+  size = isize;
+  for( int k = 0 ; k < njob ; k++ ) {
+    MPI_Pack_size(len[k],MPI_CHAR,MPI_COMM_WORLD,&csize);
+    size += isize + csize;
   }
-
-  /*
-  for( int i = 0 ; i < argc2 ; i++ ) {
-    cout << wargv[i] << " ";
+  if( _Sendbuf.size() < size ) {
+    _Sendbuf.resize(size);
   }
-  cout << endl;
-  */
 
-  delete [] param;
+  head[0] = retry;
+  head[1] = njob;
+  MPI_Pack(head,2,MPI_INT,&_Sendbuf[0],size,&position,MPI_COMM_WORLD);
+  for( int k = 0 ; k < njob ; k++ ) {
+    head[0] = jobid[k];
+    head[1] = len[k];
+    MPI_Pack(head,2,MPI_INT,&_Sendbuf[0],size,&position,MPI_COMM_WORLD);
+    MPI_Pack((void *)line[k],head[1],MPI_CHAR,&_Sendbuf[0],size,&position,MPI_COMM_WORLD);
+  }
 
-  return argc2;
+  MPI_Send(&_Sendbuf[0],position,MPI_PACKED,wid,500,MPI_COMM_WORLD);
 }
 
 //============================================================================//
-void Mpidp::for_worker(int &retry,char *ctable,int &ia,
-           string &argv_joblist)
-// Preparation using system call version by workers
+int Mpidp::recv_result(vector<int> &ir)
+// receive results from any worker (return worker id)
+//   njob x ( [job id][RET][FILE][wall][user][sys][max RSS][CACHE] )
+//   (-1 : a rank was lost, -2 : _Wakeup time)
 //============================================================================//
 {
-  string  position;
-  string  tstock;
-  char    tag[5];
-  char    *saveptr;
+  int count, flag;
 
-  strcpy(_Name,strtok_r(ctable,"\t",&saveptr));
-
-  if( ia ) {
-    argv_joblist = strtok_r(NULL,"\t",&saveptr) + argv_joblist;
+  // the journal is written while no result is waiting
+  if( !_Journal_buf.empty() ) {
+    MPI_Iprobe(MPI_ANY_SOURCE,600,MPI_COMM_WORLD,&flag,&_Status);
+    if( !flag ) {
+      flush_journal(0);
+    }
   }
-  else {
-    for( int i = 0 ; i < _Ndata-1 ; i++ ) {
-      sprintf(tag,"$%d",i+1);
-      position = tag;
-      tstock = strtok_r(NULL,"\t",&saveptr);
+  write_status(0);
 
-      if( _Out_option == i+1 ) {
-        if( retry ) {
-          sprintf(tag,"%d",retry);
-          tstock += ".";
-          tstock += tag;
+  // heartbeats (700) are taken while waiting (-hb, and ticks for -st)
+  //   MPI has no probe with a timeout, so lost ranks (-hb, -dl) and _Wakeup
+  //   are looked for between polls, and otherwise MPI_Probe blocks
+  //   (a snapshot of -st is written at the first message after it is due)
+  int tag = (_Watch || !_Status_file.empty()) ? MPI_ANY_TAG : 600;
+  double due = (_Watch || _Wakeup > 0.0) ? next_Due() : -1.0;
+  double nap = 1.0e-5;      // poll interval (10 usec., doubled up to 0.2 msec.)
+
+  while(1) {
+    if( due < 0.0 ) {      // nothing to do until a message comes
+      MPI_Probe(MPI_ANY_SOURCE,tag,MPI_COMM_WORLD,&_Status);
+    }
+    else {
+      // silent ranks, the status file (-st) and _Wakeup are checked when due
+      MPI_Iprobe(MPI_ANY_SOURCE,tag,MPI_COMM_WORLD,&flag,&_Status);
+      if( !flag ) {
+        double now = MPI_Wtime();
+        if( now < due ) {
+          usleep((useconds_t)(min(nap,due-now) * 1.0e6) + 1);
+          nap = min(2.0 * nap,2.0e-4);
+          continue;
         }
-        _Out_file = tstock;
+        if( _Watch && (_Lost = check_Worker()) > 0 ) {
+          return -1;
+        }
+        if( _Wakeup > 0.0 && now >= _Wakeup ) {
+          _Wakeup = 0.0;
+          return -2;
+        }
+        write_status(0);
+        due = (_Watch || _Wakeup > 0.0) ? next_Due() : -1.0;
+        continue;
       }
-
-      // character is replaced
-      argv_joblist = replace_pattern(argv_joblist,position,tstock);
+      nap = 1.0e-5;
     }
-  }
 
-  //  cout << argv_joblist << endl;
+    MPI_Get_count(&_Status,MPI_INT,&count);
+    int wid = _Status.MPI_SOURCE;
+    int rtag = _Status.MPI_TAG;
+    ir.resize(max(count,1));
+    MPI_Recv(&ir[0],count,MPI_INT,wid,rtag,MPI_COMM_WORLD,&_Status);
+    ir.resize(count);
 
-  return;
-}
+    if( _Watch && _Workerlog[wid].lost ) continue;    // too late
+    _Workerlog[wid].heard = MPI_Wtime();
+
+    if( rtag == 600 ) {
+      return wid;
+    }
+    write_status(0);
+  }
+}
+
+//============================================================================//
+void Mpidp::send_heartbeat(const int busy)
+// send a heartbeat to the parent every _Heartbeat sec. while the rank has jobs
+//============================================================================//
+{
+  if( _Heartbeat <= 0.0 || !busy ) return;
+
+  double now = MPI_Wtime();
+  if( now - _Beat >= _Heartbeat ) {
+    MPI_Send(&busy,1,MPI_INT,_Parent,700,MPI_COMM_WORLD);
+    _Beat = now;
+  }
+}
+
+//============================================================================//
+void Mpidp::recv_job(deque<JobMessage> &jobqueue)
+// receive messages from master into jobqueue
+//   wait for a message if jobqueue is empty, and take all arrived messages
+//============================================================================//
+{
+  int flag;
+
+  while(1) {
+    if( jobqueue.empty() ) {
+      MPI_Probe(_Parent,500,MPI_COMM_WORLD,&_Status);
+    }
+    else {
+      MPI_Iprobe(_Parent,500,MPI_COMM_WORLD,&flag,&_Status);
+      if( !flag ) break;
+    }
+
+    jobqueue.push_back(JobMessage());
+    recv_job(jobqueue.back());
+
+    if( jobqueue.back().jobid.empty() ) break;  // Table End flag
+  }
+}
+
+//============================================================================//
+void Mpidp::recv_job(JobMessage &job)
+// receive the message found by MPI_Probe (_Status)
+//============================================================================//
+{
+  int size;
+  int head[2];
+  int position = 0;
+
+  MPI_Get_count(&_Status,MPI_PACKED,&size);
+  if( _Sendbuf.size() < size ) {
+    _Sendbuf.resize(size);
+  }
+  MPI_Recv(&_Sendbuf[0],size,MPI_PACKED,_Parent,500,MPI_COMM_WORLD,&_Status);
+
+  MPI_Unpack(&_Sendbuf[0],size,&position,head,2,MPI_INT,MPI_COMM_WORLD);
+  job.retry = head[0];
+  int njob = head[1];
+
+  job.jobid.resize(njob);
+  job.offset.resize(njob);
+  for( int k = 0 ; k < njob ; k++ ) {
+    MPI_Unpack(&_Sendbuf[0],size,&position,head,2,MPI_INT,MPI_COMM_WORLD);
+    job.jobid[k] = head[0];
+    job.offset[k] = job.ctable.size();
+    job.ctable.resize(job.offset[k] + head[1] + 1);
+    MPI_Unpack(&_Sendbuf[0],size,&position,&job.ctable[job.offset[k]],head[1],MPI_CHAR,MPI_COMM_WORLD);
+    job.ctable[job.offset[k] + head[1]] = '\0';
+  }
+}
+
+//============================================================================//
+pid_t Mpidp::spawn_job(const string &command)
+// start a command line as a child process (in a new process group)
+//   -ln 0 : /bin/sh -c command (same as system())
+//   -ln 1 : the program is started directly unless the line needs a shell
+//============================================================================//
+{
+  pid_t pid;
+  vector<string> args;
+
+  // a job has its own process group to be killed with its children
+  posix_spawnattr_t attr;
+  sigset_t mask;
+  sigemptyset(&mask);
+  posix_spawnattr_init(&attr);
+  posix_spawnattr_setflags(&attr,POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGMASK);
+  posix_spawnattr_setpgroup(&attr,0);
+  posix_spawnattr_setsigmask(&attr,&mask);    // SIGCHLD is blocked in the worker
+
+  if( _Launcher == 1 && split_command(command,args) ) {
+    vector<char *> cargv(args.size()+1,(char *)NULL);
+    for( int i = 0 ; i < args.size() ; i++ ) {
+      cargv[i] = (char *)args[i].c_str();
+    }
+    if( posix_spawnp(&pid,cargv[0],NULL,&attr,&cargv[0],environ) == 0 ) {
+      posix_spawnattr_destroy(&attr);
+      return pid;
+    }
+    // the shell reports a program which was not found (exit status 127)
+  }
+
+  const char *sargv[] = { "sh", "-c", command.c_str(), NULL };
+  int err = posix_spawn(&pid,"/bin/sh",NULL,&attr,(char * const *)sargv,environ);
+  posix_spawnattr_destroy(&attr);
+  if( err != 0 ) {
+    cerr << "[ERROR] Job [" << command << "] was not started : " << strerror(err) << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+
+  return pid;
+}
+
+//============================================================================//
+int Mpidp::split_command(const string &command,vector<string> &args)
+// split a command line at spaces and tabs
+//   (0 : the line uses redirection, pipes, quotes or other shell syntax)
+//============================================================================//
+{
+  static const char *shell_char = "|&;<>()$`\\\"'*?[]#~{}!\n";
+
+  args.clear();
+  for( size_t pos = 0 ; pos < command.size() ; ) {
+    if( command[pos] == ' ' || command[pos] == '\t' ) {
+      pos++;
+      continue;
+    }
+
+    size_t end = command.find_first_of(" \t",pos);
+    if( end == string::npos ) {
+      end = command.size();
+    }
+    args.push_back(command.substr(pos,end-pos));
+    pos = end;
+  }
+
+  if( args.empty() || args[0].find('=') != string::npos ) {
+    return 0;    // empty line or variable assignment
+  }
+  return command.find_first_of(shell_char) == string::npos;
+}
+
+//============================================================================//
+int Mpidp::argument(int argc,char *argv[],char **wargv)
+// Procedure of options for function call version
+//============================================================================//
+{
+  int ic = 0;
+
+  for( int i = 0 ; i < argc ; i++ ) {
+    if( mpidp_option(argv[i]) ) {
+      i++;
+    }
+    else {
+      strcpy(wargv[ic++],argv[i]);
+    }
+  }
+
+  return ic;
+}
+
+//============================================================================//
+int Mpidp::argument(int argc,char *argv[],string &main_argv)
+// Procedure of options for system call version
+//============================================================================//
+{
+  int iflag = 1;
+
+  for( int i = 1 ; i < argc ; i++ ) {
+    if( !strncmp(argv[i],"-pg",3) ) {
+      main_argv = argv[++i];
+      iflag = 0;
+    }
+    else if( mpidp_option(argv[i]) ) {
+      i++;
+    }
+    else {
+      main_argv += ' ';
+      main_argv += argv[i];
+    }
+  }
+
+  return iflag;
+}
+
+//============================================================================//
+int Mpidp::for_worker(int &retry,char *ctable,int argc2,char **wargv)
+// Preparation using function call version by workers
+//============================================================================//
+{
+  string  position;
+  string  tstock;
+  string  sparam = _Param;
+  char    tag[5], *elem;
+  char    *saveptr;
+
+  for( int i = 0 ; i < _Ndata-1 ; i++ ) {
+    sprintf(tag,"$%d",i+1);
+    position = tag;
+    tstock = strtok_r(i ? NULL : ctable,"\t",&saveptr);
+
+    if( _Out_option == i+1 ) {
+      if( retry ) {
+        sprintf(tag,"%d",retry);
+        tstock += ".";
+        tstock += tag;
+      }
+      _Out_file = tstock;
+    }
+
+    // character is replaced
+    sparam = replace_pattern(sparam,position,tstock);
+  }
+
+  char *param = new char[sparam.size()+1];
+  strcpy(param,sparam.c_str());
+  strcpy(wargv[argc2++],strtok_r(param," ",&saveptr));
+
+  while( (elem = strtok_r(NULL," ",&saveptr)) ) {
+    strcpy(wargv[argc2++],elem);
+  }
+
+  /*
+  for( int i = 0 ; i < argc2 ; i++ ) {
+    cout << wargv[i] << " ";
+  }
+  cout << endl;
+  */
+
+  delete [] param;
+
+  return argc2;
+}
+
+//============================================================================//
+void Mpidp::for_worker(int &retry,char *ctable,int &ia,
+           string &argv_joblist)
+// Preparation using system call version by workers
+//============================================================================//
+{
+  string  position;
+  string  tstock;
+  char    tag[5];
+  char    *saveptr;
+
+  if( ia ) {
+    argv_joblist = strtok_r(ctable,"\t",&saveptr) + argv_joblist;
+  }
+  else {
+    for( int i = 0 ; i < _Ndata-1 ; i++ ) {
+      sprintf(tag,"$%d",i+1);
+      position = tag;
+      tstock = strtok_r(i ? NULL : ctable,"\t",&saveptr);
+
+      if( _Out_option == i+1 ) {
+        if( retry ) {
+          sprintf(tag,"%d",retry);
+          tstock += ".";
+          tstock += tag;
+        }
+        _Out_file = tstock;
+      }
+
+      // character is replaced
+      argv_joblist = replace_pattern(argv_joblist,position,tstock);
+    }
+  }
+
+  //  cout << argv_joblist << endl;
+
+  return;
+}
+
+//============================================================================//
+string Mpidp::replace_pattern(const string &pattern, const string &position, const string &option) {
+// the pattern of a character is replaced 
+//============================================================================//
+  string  command;
+  int  pos_before = 0;
+  int  pos = 0;
+  int  len = position.size();
+  
+  while( (pos = pattern.find(position, pos)) != std::string::npos) {
+    command.append(pattern, pos_before, pos - pos_before);
+    command.append(option);
+    pos += len;
+    pos_before = pos;
+  }
+
+  command.append(pattern, pos_before, pattern.size() - pos_before);
+
+  return command;
+}
+
+//============================================================================//
+void Mpidp::add_line(const char *line,const size_t len)
+// append a table line to _Table_text
+//============================================================================//
+{
+  _Table_text.append(line,len);
+  _Table_offset.push_back(_Table_text.size());
+  _Table_njob++;
+  _Table_base = _Table_text.data();
+  _Table_index = &_Table_offset[0];
+}
+
+//============================================================================//
+int Mpidp::table_size()
+// # of table lines
+//============================================================================//
+{
+  return _Table_njob;
+}
+
+//============================================================================//
+const char *Mpidp::table_ptr(const int i)
+// i-th table line (not terminated by '\0')
+//============================================================================//
+{
+  return _Table_base + _Table_index[i];
+}
+
+//============================================================================//
+int Mpidp::table_len(const int i)
+// length of i-th table line
+//============================================================================//
+{
+  return _Table_index[i+1] - _Table_index[i];
+}
+
+//============================================================================//
+string Mpidp::table_line(const int i)
+// copy of i-th table line
+//============================================================================//
+{
+  return string(table_ptr(i),table_len(i));
+}
+
+//============================================================================//
+string Mpidp::table_column(const int i,const int col)
+// col-th column (1,2,...) of i-th table line
+//   (split when the table was compiled)
+//============================================================================//
+{
+  if( _Column_ptr == NULL ) {
+    return get_column(table_line(i),col);
+  }
+
+  long long k = _Column_ptr[i] + col - 1;
+  if( col < 1 || k >= _Column_ptr[i+1] ) {
+    return "";
+  }
+  int end = (k+1 < _Column_ptr[i+1]) ? _Column_off[k+1] - 1 : table_len(i);
+
+  return string(table_ptr(i) + _Column_off[k],end - _Column_off[k]);
+}
+
+//============================================================================//
+int Mpidp::map_table(vector<int> &task_id,int &csize,ofstream &logout)
+// map a compiled table file (-cp) instead of reading it
+//   (return 0 : a text table file)
+//============================================================================//
+{
+  TableHeader head;
+  struct stat st;
+
+  int fd = open(_Table_file.c_str(),O_RDONLY);
+  if( fd < 0 ) {
+    return 0;
+  }
+  if( read(fd,&head,sizeof(head)) != sizeof(head) ||
+      memcmp(head.magic,TABLE_MAGIC,8) ) {
+    close(fd);
+    return 0;
+  }
+
+  if( fstat(fd,&st) != 0 || head.version != TABLE_VERSION || head.size != st.st_size ) {
+    cerr << "[ERROR] Compiled table [" << _Table_file << "] is broken or of another version!!" << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+  if( head.job_order != _Job_order ) {
+    cerr << "[ERROR] Compiled table [" << _Table_file << "] is for -jo " << head.job_order << "!!" << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+
+  // the mapping is kept until the end of the run
+  void *map = mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+  close(fd);
+  if( map == MAP_FAILED ) {
+    cerr << "[ERROR] Compiled table [" << _Table_file << "] was not mapped!!" << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+  const char *base = (const char *)map;
+
+  if( !check_table(head,base) ) {
+    cerr << "[ERROR] Compiled table [" << _Table_file << "] is broken or of another version!!" << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+
+  if( head.title_len >= 0 ) {
+    _Title.assign(base + head.title,head.title_len);
+    logout << "TITLE=" << _Title << endl;
+  }
+  if( head.param_len >= 0 ) {
+    _Param.assign(base + head.param,head.param_len);
+    _Psize = _Param.size() + 1;
+    logout << "PARAM=" << _Param << endl;
+  }
+
+  _Table_njob = head.njob;
+  _Table_base = base + head.text;
+  _Table_index = (const long long *)(base + head.offset);
+  _Column_ptr = (const long long *)(base + head.column_ptr);
+  _Column_off = (const int *)(base + head.column_off);
+  if( _Job_order ) {
+    const int *id = (const int *)(base + head.task_id);
+    const int *ptr = (const int *)(base + head.dep_ptr);
+    const int *idx = (const int *)(base + head.dep_idx);
+    task_id.assign(id,id + head.njob);
+    _Dep_ptr.assign(ptr,ptr + head.njob + 1);
+    _Dep_idx.assign(idx,idx + head.ndep);
+  }
+  csize = head.csize;
+
+  logout << "Compiled table : " << head.njob << " jobs" << endl;
+
+  return 1;
+}
+
+//============================================================================//
+int Mpidp::check_table(const TableHeader &head,const char *base)
+// every section of a mapped compiled table lies in the file,
+//   and its line offsets, columns and depend ids are in range
+//   (return 0 : broken)
+//============================================================================//
+{
+  const long long INT_LIMIT = 0x7fffffffLL;
+
+  if( head.njob < 0 || head.njob >= INT_LIMIT || head.ndep < 0 || head.ndep > INT_LIMIT ||
+      head.ncolumn < 0 || head.csize < 0 || head.csize > INT_LIMIT - 8 ||
+      head.title_len < -1 || head.title_len > head.size ||
+      head.param_len < -1 || head.param_len > head.size ) {
+    return 0;
+  }
+
+  // offset and # of elements of each section
+  int jo = _Job_order ? 1 : 0;
+  long long offset[9] = { head.title, head.param, head.offset, head.column_ptr, head.column_off,
+                          head.task_id, head.dep_ptr, head.dep_idx, head.text };
+  long long count[9] = { max(head.title_len,0LL), max(head.param_len,0LL), head.njob+1,
+                         head.njob+1, head.ncolumn, jo * head.njob, jo * (head.njob+1),
+                         jo * head.ndep, 0 };
+  long long elem[9] = { 1, 1, sizeof(long long), sizeof(long long), sizeof(int),
+                        sizeof(int), sizeof(int), sizeof(int), 1 };
+
+  for( int s = 0 ; s < 9 ; s++ ) {
+    if( s == 8 ) {
+      count[s] = ((const long long *)(base + head.offset))[head.njob];
+    }
+    if( offset[s] < (long long)sizeof(head) || offset[s] % 8 || offset[s] > head.size ||
+        count[s] < 0 || count[s] > (head.size - offset[s]) / elem[s] ) {
+      return 0;
+    }
+  }
+
+  // lines are in the text, and columns in their lines
+  const long long *line = (const long long *)(base + head.offset);
+  const long long *cptr = (const long long *)(base + head.column_ptr);
+  const int *coff = (const int *)(base + head.column_off);
+  if( line[0] != 0 || cptr[0] != 0 || cptr[head.njob] != head.ncolumn ) {
+    return 0;
+  }
+  for( long long i = 0 ; i < head.njob ; i++ ) {
+    long long len = line[i+1] - line[i];
+    if( len < 0 || len > head.csize || cptr[i+1] <= cptr[i] || coff[cptr[i]] != 0 ) {
+      return 0;
+    }
+    for( long long k = cptr[i]+1 ; k < cptr[i+1] ; k++ ) {
+      if( coff[k] <= coff[k-1] || coff[k] > len ) {
+        return 0;
+      }
+    }
+  }
+
+  // depend ids are job ids
+  if( jo ) {
+    const int *ptr = (const int *)(base + head.dep_ptr);
+    const int *idx = (const int *)(base + head.dep_idx);
+    if( ptr[0] != 0 || ptr[head.njob] != head.ndep ) {
+      return 0;
+    }
+    for( long long i = 0 ; i < head.njob ; i++ ) {
+      if( ptr[i+1] < ptr[i] ) {
+        return 0;
+      }
+    }
+    for( long long k = 0 ; k < head.ndep ; k++ ) {
+      if( idx[k] < 0 || idx[k] >= head.njob ) {
+        return 0;
+      }
+    }
+  }
+
+  return 1;
+}
+
+//============================================================================//
+void Mpidp::compile_table(const vector<int> &task_id,const int csize,ofstream &logout)
+// write the table in the compiled format (-cp)
+//   depend task ids are already job ids
+//============================================================================//
+{
+  TableHeader head;
+  long long njob = table_size();
+  vector<long long> column_ptr(1,0);
+  vector<int> column_off;
+
+  for( int i = 0 ; i < njob ; i++ ) {
+    const char *line = table_ptr(i);
+    column_off.push_back(0);
+    for( int k = 0 ; k < table_len(i) ; k++ ) {
+      if( line[k] == '\t' ) {
+        column_off.push_back(k+1);
+      }
+    }
+    column_ptr.push_back(column_off.size());
+  }
+
+  // sections and their sizes
+  const void *data[9] = { _Title.data(), _Param.data(), _Table_index, &column_ptr[0],
+                          column_off.empty() ? NULL : &column_off[0],
+                          task_id.empty() ? NULL : &task_id[0], &_Dep_ptr[0],
+                          _Dep_idx.empty() ? NULL : &_Dep_idx[0], _Table_base };
+  long long size[9] = { (long long)_Title.size(), (long long)_Param.size(),
+                        (njob+1) * (long long)sizeof(long long),
+                        (njob+1) * (long long)sizeof(long long),
+                        (long long)(column_off.size() * sizeof(int)),
+                        (long long)(task_id.size() * sizeof(int)),
+                        (long long)(_Dep_ptr.size() * sizeof(int)),
+                        (long long)(_Dep_idx.size() * sizeof(int)),
+                        _Table_index[njob] };
+  long long *offset[9] = { &head.title, &head.param, &head.offset, &head.column_ptr,
+                           &head.column_off, &head.task_id, &head.dep_ptr,
+                           &head.dep_idx, &head.text };
+
+  memset(&head,0,sizeof(head));
+  memcpy(head.magic,TABLE_MAGIC,8);
+  head.version = TABLE_VERSION;
+  head.job_order = _Job_order;
+  head.njob = njob;
+  head.ncolumn = column_off.size();
+  head.ndep = _Dep_idx.size();
+  head.csize = csize;
+  head.title_len = (_Title == string("MPIDP ") + VERSION) ? -1 : _Title.size();
+  head.param_len = (_Param == "MPIDP") ? -1 : _Param.size();
+  long long pos = (sizeof(head) + 7) / 8 * 8;
+  for( int s = 0 ; s < 9 ; s++ ) {
+    *offset[s] = pos;
+    pos = (pos + size[s] + 7) / 8 * 8;
+  }
+  head.size = pos;
+
+  // written to a temporary file, and renamed
+  char pid[32];
+  sprintf(pid,".%d",(int)getpid());
+  string tmp = _Compile_file + pid;
+  FILE *fp = fopen(tmp.c_str(),"wb");
+  if( fp == NULL ) {
+    cerr << "[ERROR] Compiled table [" << _Compile_file << "] was not opened!!" << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+
+  int ok = (fwrite(&head,sizeof(head),1,fp) == 1);
+  static const char pad[8] = { 0 };
+  long long written = sizeof(head);
+  for( int s = 0 ; s < 9 && ok ; s++ ) {
+    ok = (fwrite(pad,1,*offset[s]-written,fp) == *offset[s]-written);
+    if( ok && size[s] > 0 ) {
+      ok = (fwrite(data[s],1,size[s],fp) == size[s]);
+    }
+    written = *offset[s] + size[s];
+  }
+  ok = ok && (fwrite(pad,1,head.size-written,fp) == head.size-written);
+  ok = (fclose(fp) == 0) && ok;
+
+  if( !ok || rename(tmp.c_str(),_Compile_file.c_str()) != 0 ) {
+    unlink(tmp.c_str());
+    cerr << "[ERROR] Compiled table [" << _Compile_file << "] was not written!!" << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+
+  logout << "Compiled table : " << _Compile_file << " (" << njob << " jobs, "
+         << head.size << " bytes)" << endl << endl;
+}
+
+//============================================================================//
+int Mpidp::compileOnly(const int &nproc)
+// the run ends after the table was compiled (-cp with no worker)
+//============================================================================//
+{
+  return (nproc == 1 && !_Compile_file.empty());
+}
+
+//============================================================================//
+string Mpidp::get_column(const string &line,const int col)
+// get col-th column (1,2,...) of a table line
+//============================================================================//
+{
+  size_t pos = 0;
+
+  for( int i = 1 ; i < col ; i++ ) {
+    pos = line.find('\t',pos);
+    if( pos == string::npos ) {
+      return "";
+    }
+    pos++;
+  }
+
+  size_t end = line.find('\t',pos);
+  if( end == string::npos ) {
+    end = line.size();
+  }
+
+  return line.substr(pos,end-pos);
+}
+
+//============================================================================//
+void Mpidp::write_table(const int &nproc,ofstream &logout)
+// write JOB and Workers report
+//============================================================================//
+{
+  // JOB table
+  logout << "JOB table :" << endl;
+
+  for( int i = 0 ; i < table_size() ; i++ ) {
+    logout << _Namelog[i].name << " EXEC=" << _Namelog[i].exec;
+
+    for( int j = 0 ; j < _Namelog[i].worker.size() ; j++ ) {
+      logout << " (WID=" << _Namelog[i].worker[j];
+      logout << " END=" << _Namelog[i].rcode[0][j];
+      logout << " RET=" << _Namelog[i].rcode[1][j];
+      logout << " FILE=" << _Namelog[i].rcode[2][j];
+      if( _Namelog[i].rcode[0][j] ) {
+        logout << " WAIT=" << _Namelog[i].time[1][j] - _Namelog[i].time[0][j];
+        logout << " RUN=" << _Namelog[i].usage[0][j] / 1000.0;
+        logout << " USER=" << _Namelog[i].usage[1][j] / 1000.0;
+        logout << " SYS=" << _Namelog[i].usage[2][j] / 1000.0;
+        logout << " RSS=" << _Namelog[i].usage[3][j];
+      }
+      logout << ")";
+    }
+    logout << endl;
+  }
+
+  // queue wait and run time of returned jobs (sec), and busy time of ranks
+  double elapsed = MPI_Wtime() - _Start_time;
+  int nrun = 0;
+  double wait = 0.0, run = 0.0, cpu = 0.0;
+  int rss = 0;
+  vector<double> busy(nproc,0.0);
+  vector<int> njob(nproc,0);
+
+  for( int i = 0 ; i < table_size() ; i++ ) {
+    for( int j = 0 ; j < _Namelog[i].worker.size() ; j++ ) {
+      if( _Namelog[i].rcode[0][j] == 0 ) continue;
+      nrun++;
+      wait += _Namelog[i].time[1][j] - _Namelog[i].time[0][j];
+      run += _Namelog[i].usage[0][j] / 1000.0;
+      cpu += (_Namelog[i].usage[1][j] + _Namelog[i].usage[2][j]) / 1000.0;
+      rss = max(rss,_Namelog[i].usage[3][j]);
+      busy[_Namelog[i].worker[j]] += _Namelog[i].usage[0][j] / 1000.0;
+      njob[_Namelog[i].worker[j]] ++;
+    }
+  }
+
+  logout << "\nJob timing :" << endl;
+  logout << "#Run          = " << nrun << endl;
+  if( nrun > 0 ) {
+    logout << "Mean wait     = " << wait / nrun << " sec." << endl;
+    logout << "Mean run time = " << run / nrun << " sec." << endl;
+    logout << "CPU time      = " << cpu << " sec." << endl;
+    logout << "Max RSS       = " << rss << " KB" << endl;
+  }
+
+  // utilization = busy time / (elapsed time x job slots under the rank)
+  logout << "\nWorker utilization :" << endl;
+
+  for( int m = 0 ; m < _Member.size() ; m++ ) {
+    int i = _Member[m];
+    double util = (elapsed > 0.0) ? 100.0 * busy[i] / (elapsed * _Weight[i] * _Slot) : 0.0;
+    logout << i << "\t" << njob[i] << "\t" << busy[i] << " sec.\t" << util << " %" << endl;
+  }
+
+  // Worker table
+  logout << "\nWorker table :" << endl;
+
+  for( int i = 1 ; i < nproc ; i++ ) {
+    logout << i << "\t" << _Workerlog[i].name.size();
+
+    for( int j = 0 ; j < _Workerlog[i].name.size() ; j++ ) {
+      logout << "\t" << _Workerlog[i].name[j] << "\t" << _Workerlog[i].rcode[j];
+    }
+    logout << endl;
+  }
+
+  delete [] _Workerlog;
+  delete [] _Namelog;
+
+  return;
+}
+
+//============================================================================//
+void Mpidp::write_trace(const int &nproc)
+// write the run in Chrome trace event format (-tr file)
+//   pid 0 : master (dispatch, completion and release of DAG jobs)
+//   pid i : rank i, one slice per job attempt (jobs run at once on the rank
+//           are put on different tids)
+//============================================================================//
+{
+  if( _Trace_file.empty() ) return;
+
+  ofstream Output(_Trace_file.c_str(),ios::out);
+  if( !Output ) {
+    cerr << "[WARNING] Trace file [" << _Trace_file << "] was not opened." << endl;
+    return;
+  }
+
+  double end = MPI_Wtime() - _Start_time;
+  vector<vector<double> > lane(nproc);  // end time of the last slice of each tid
+
+  Output << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << endl;
+  Output << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"master\"}}";
+  for( int i = 1 ; i < nproc ; i++ ) {
+    Output << ",\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << i
+           << ",\"args\":{\"name\":\"rank " << i << "\"}}";
+  }
+
+  // attempts in the order of start time
+  vector<pair<double,pair<int,int> > > attempt;    // < start , < job id , attempt > >
+  for( int i = 0 ; i < table_size() ; i++ ) {
+    for( int j = 0 ; j < _Namelog[i].worker.size() ; j++ ) {
+      double t1 = _Namelog[i].rcode[0][j] ? _Namelog[i].time[1][j] : _Namelog[i].time[0][j];
+      attempt.push_back(make_pair(t1,make_pair(i,j)));
+    }
+  }
+  sort(attempt.begin(),attempt.end());
+
+  for( int k = 0 ; k < attempt.size() ; k++ ) {
+    int i = attempt[k].second.first;
+    int j = attempt[k].second.second;
+    NameLog &log = _Namelog[i];
+    int wid = log.worker[j];
+    double t0 = log.time[0][j];
+    double t1 = attempt[k].first;                        // (not returned :
+    double t2 = log.rcode[0][j] ? log.time[2][j] : end;  //  dispatch to the end)
+
+    // the first tid which is free at the start
+    int tid = 0;
+    while( tid < lane[wid].size() && lane[wid][tid] > t1 ) tid++;
+    if( tid == lane[wid].size() ) lane[wid].push_back(0.0);
+    lane[wid][tid] = t2;
+
+    Output << ",\n{\"name\":\"" << i+1 << "\",\"cat\":\"job\",\"ph\":\"X\",\"pid\":" << wid
+           << ",\"tid\":" << tid << ",\"ts\":" << (long long)(t1*1.0e6)
+           << ",\"dur\":" << (long long)((t2-t1)*1.0e6) << ",\"args\":{\"attempt\":" << j+1;
+    if( log.rcode[0][j] ) {
+      Output << ",\"RET\":" << log.rcode[1][j] << ",\"FILE\":" << log.rcode[2][j]
+             << ",\"wait\":" << t1-t0 << ",\"user\":" << log.usage[1][j]/1000.0
+             << ",\"sys\":" << log.usage[2][j]/1000.0 << ",\"rss\":" << log.usage[3][j];
+    }
+    else {
+      Output << ",\"END\":0";
+    }
+    Output << "}}";
+
+    Output << ",\n{\"name\":\"dispatch\",\"cat\":\"master\",\"ph\":\"i\",\"s\":\"t\",\"pid\":0,\"tid\":0"
+           << ",\"ts\":" << (long long)(t0*1.0e6) << ",\"args\":{\"job\":" << i+1
+           << ",\"rank\":" << wid << "}}";
+    if( log.rcode[0][j] ) {
+      Output << ",\n{\"name\":\"complete\",\"cat\":\"master\",\"ph\":\"i\",\"s\":\"t\",\"pid\":0,\"tid\":0"
+             << ",\"ts\":" << (long long)(t2*1.0e6) << ",\"args\":{\"job\":" << i+1
+             << ",\"rank\":" << wid << "}}";
+    }
+  }
+
+  for( int k = 0 ; k < _Release.size() ; k++ ) {
+    Output << ",\n{\"name\":\"release\",\"cat\":\"master\",\"ph\":\"i\",\"s\":\"t\",\"pid\":0,\"tid\":0"
+           << ",\"ts\":" << (long long)(_Release[k].first*1.0e6)
+           << ",\"args\":{\"job\":" << _Release[k].second+1 << "}}";
+  }
+  Output << "\n]}" << endl;
+}
+
+//============================================================================//
+void Mpidp::write_status(const int force)
+// rewrite the status file every _Status_interval sec. (-st file)
+//   the file is replaced by rename(), so a reader never sees a half file
+//============================================================================//
+{
+  if( _Status_file.empty() ) return;
+
+  double now = MPI_Wtime() - _Start_time;
+  if( !force && _Status_time >= 0.0 && now - _Status_time < _Status_interval ) return;
+
+  // states of jobs are counted when they change
+  int tbsize = table_size();
+  if( _Status_state.empty() ) {
+    update_status(-1);
+  }
+  int ndone = _Status_count[0] + _Status_count[1];
+  int nfail = _Status_count[1];
+  int nrun = _Status_count[2];
+  int nready = _Status_count[3];
+  int nblock = _Status_count[4];
+  double predict = _Status_predict;
+
+  // job slots of ranks which take jobs
+  int nslot = 0, nbusy = 0, nlost = 0, nsleep = 0;
+  for( int m = 0 ; m < _Member.size() ; m++ ) {
+    int wid = _Member[m];
+    if( _Workerlog[wid].lost ) {
+      nlost++;
+    }
+    else if( _Workerlog[wid].queue < 0 ) {
+      nsleep++;
+    }
+    else {
+      nslot += _Weight[wid] * _Slot;
+      nbusy += min(_Workerlog[wid].run,_Weight[wid] * _Slot);
+    }
+  }
+
+  // throughput of the last interval (the whole run for the first and last snapshots)
+  if( force ) {
+    _Status_time = -1.0;
+    _Status_ndone = 0;
+  }
+  double interval = (_Status_time >= 0.0) ? now - _Status_time : now;
+  double rate = (interval > 0.0) ? (ndone - _Status_ndone) / interval : 0.0;
+  if( rate <= 0.0 && now > 0.0 ) {
+    rate = ndone / now;
+  }
+  _Status_time = now;
+  _Status_ndone = ndone;
+
+  char date[32];
+  time_t t = time(NULL);
+  strftime(date,sizeof(date),"%Y/%m/%d %H:%M:%S",localtime(&t));
+
+  char tmp[32];
+  sprintf(tmp,".%d",(int)getpid());
+  string path = _Status_file + tmp;
+
+  ofstream Output(path.c_str(),ios::out | ios::trunc);
+  Output << "MPIDP status  : " << date << endl;
+  Output << "Elapsed time  = " << now << " sec." << endl;
+  Output << "#JOB          = " << tbsize << endl;
+  Output << "Done          = " << ndone << " (failed " << nfail << ")" << endl;
+  Output << "Running       = " << nrun << endl;
+  Output << "Ready         = " << nready << endl;
+  Output << "Blocked       = " << nblock << endl;
+  Output << "Throughput    = " << rate << " jobs/sec. (last " << interval << " sec.)" << endl;
+  Output << "Busy slots    = " << nbusy << " / " << nslot;
+  if( nslot > 0 ) {
+    Output << " (" << 100.0 * nbusy / nslot << " %)";
+  }
+  Output << endl;
+  Output << "Failed ranks  = " << nlost + nsleep << " (lost " << nlost << ", sleeping " << nsleep << ")" << endl;
+  if( ndone == tbsize ) {
+    Output << "ETA           = finished" << endl;
+  }
+  else if( rate > 0.0 ) {
+    double eta = (tbsize - ndone) / rate;
+    t += (time_t)eta;
+    strftime(date,sizeof(date),"%Y/%m/%d %H:%M:%S",localtime(&t));
+    Output << "ETA           = " << eta << " sec. (" << date << ")" << endl;
+  }
+  else {
+    Output << "ETA           = unknown" << endl;
+  }
+  if( _Npredict > 0 && ndone < tbsize && nslot > 0 ) {
+    Output << "ETA (history) = " << predict / nslot << " sec." << endl;
+  }
+  Output.close();
+
+  if( !Output || rename(path.c_str(),_Status_file.c_str()) != 0 ) {
+    unlink(path.c_str());
+  }
+}
+
+//============================================================================//
+int Mpidp::job_State(const int i)
+// state of a job in the status file
+//   (0 : done, 1 : failed, 2 : running, 3 : ready, 4 : blocked)
+//============================================================================//
+{
+  NameLog &log = _Namelog[i];
+
+  if( _Done[i] ) {    // skipped (restart or up to date)
+    return 0;
+  }
+
+  int success = 0, returned = 0, running = 0;
+  for( int j = 0 ; j < log.worker.size() ; j++ ) {
+    if( log.rcode[0][j] ) {
+      returned = 1;
+      if( log.rcode[1][j] == 0 && (log.rcode[2][j] == 1 || _Out_option == 0) ) success = 1;
+    }
+    else if( !_Workerlog[log.worker[j]].lost ) {
+      running = 1;
+    }
+  }
+
+  int finished = (_Ntry > 0) ? (log.status > _Ntry) : (success || (returned && !running));
+  if( finished ) {
+    return success ? 0 : 1;
+  }
+  if( running ) {
+    return 2;
+  }
+  if( log.worker.empty() && _Job_order && _JobControl[i].nwait > 0 ) {
+    return 4;      // waiting for depend jobs
+  }
+  return 3;        // not sent yet, sent again or retried
+}
+
+//============================================================================//
+void Mpidp::update_status(const int i)
+// move job i to its new state in the counters of write_status()
+//   (i = -1 : all jobs are counted, at the first call)
+//   jobs with the same line are in the state of the first one
+//============================================================================//
+{
+  if( _Status_file.empty() ) return;
+
+  int tbsize = table_size();
+  if( _Status_state.empty() ) {
+    _Status_state.assign(tbsize,0);
+    _Status_weight.assign(tbsize,1);
+    for( int k = 0 ; k < 5 ; k++ ) {
+      _Status_count[k] = 0;
+    }
+    _Status_predict = 0.0;
+    _Status_pmean = 0.0;
+    for( int k = 0 ; k < _Predict.size() ; k++ ) {
+      if( _Predict[k] >= 0.0 ) _Status_pmean += _Predict[k] / _Npredict;
+    }
+    for( int k = 0 ; k < tbsize ; k++ ) {
+      if( _Same[k] >= 0 ) _Status_weight[_Same[k]] = 0;
+    }
+    for( int k = 0 ; k < tbsize ; k++ ) {
+      if( _Status_weight[k] == 0 ) continue;
+      for( int j = _Same[k] ; j >= 0 ; j = _Same[j] ) _Status_weight[k]++;
+      _Status_state[k] = job_State(k);
+      _Status_count[_Status_state[k]] += _Status_weight[k];
+    }
+    for( int k = 0 ; k < tbsize && _Npredict > 0 ; k++ ) {
+      if( _Status_weight[k] > 0 && _Status_state[k] >= 2 ) {
+        _Status_predict += _Status_weight[k] * ((_Predict[k] >= 0.0) ? _Predict[k] : _Status_pmean);
+      }
+    }
+    return;
+  }
+  if( i < 0 || _Status_weight[i] == 0 ) return;
+
+  int state = job_State(i);
+  int w = _Status_weight[i];
+  if( state == _Status_state[i] ) return;
+
+  if( _Npredict > 0 && (_Status_state[i] >= 2) != (state >= 2) ) {
+    double p = (_Predict[i] >= 0.0) ? _Predict[i] : _Status_pmean;
+    _Status_predict += (state >= 2) ? w * p : -w * p;
+  }
+  _Status_count[_Status_state[i]] -= w;
+  _Status_count[state] += w;
+  _Status_state[i] = state;
+}
+
+//============================================================================//
+int Mpidp::getNextReadyJobID()
+//  Get next ready Job id (-1 : ready queue is empty)
+//============================================================================//
+{
+  int jobid;
+
+  if( _Priority ) {      // the longest critical path first
+    if( _Ready_heap.empty() ) {
+      return -1;
+    }
+    jobid = -_Ready_heap.top().second;
+    _Ready_heap.pop();
+  }
+  else {                 // first in first out
+    if( _Ready_queue.empty() ) {
+      return -1;
+    }
+    jobid = _Ready_queue.front();
+    _Ready_queue.pop_front();
+  }
+
+  return jobid;
+}
+
+//============================================================================//
+int Mpidp::countReadyJobID()
+//  # of jobs in ready queue
+//============================================================================//
+{
+  return _Priority ? _Ready_heap.size() : _Ready_queue.size();
+}
+
+//============================================================================//
+void Mpidp::pushReadyJobID(int jobid)
+//  Push Job id to ready queue
+//============================================================================//
+{
+  _JobControl[jobid].ready = 1;
+
+  if( _Priority ) {
+    // ties are broken by the smaller job id
+    _Ready_heap.push(pair<double,int>(_Blevel[jobid],-jobid));
+  }
+  else {
+    _Ready_queue.push_back(jobid);
+  }
+}
+
+//============================================================================//
+void Mpidp::make_Cost()
+// make _Cost[] from the cost column (-cc), or the run time predicted by history (-hs)
+//   cost = 1 (or the mean predicted run time) for other jobs
+//============================================================================//
+{
+  int tbsize = table_size();
+  double mean = 1.0;
+
+  if( _Npredict > 0 ) {
+    mean = 0.0;
+    for( int i = 0 ; i < tbsize ; i++ ) {
+      if( _Predict[i] >= 0.0 ) mean += _Predict[i];
+    }
+    mean /= _Npredict;
+  }
+
+  _Cost.assign(tbsize,mean);
+  for( int i = 0 ; i < tbsize ; i++ ) {
+    string cost = (_Cost_column > 0) ? table_column(i,_Cost_column) : "";
+    if( cost != "" ) {
+      _Cost[i] = max(atof(cost.c_str()),0.0);
+    }
+    else if( _Npredict > 0 && _Predict[i] >= 0.0 ) {
+      _Cost[i] = _Predict[i];
+    }
+  }
+}
+
+//============================================================================//
+void Mpidp::make_Order(ofstream &logout)
+// make _Order[] (dispatch order of NO JOB ORDER mode)
+//   -pr 1 : the longest cost first (LPT), ties in table order
+//============================================================================//
+{
+  int tbsize = table_size();
+
+  _Order.resize(tbsize);
+  for( int i = 0 ; i < tbsize ; i++ ) {
+    _Order[i] = i;
+  }
+  if( !_Priority ) return;
+
+  make_Cost();
+  vector<pair<double,int> > cost(tbsize);    // < -cost , job id >
+  double total = 0.0;
+  for( int i = 0 ; i < tbsize ; i++ ) {
+    cost[i] = pair<double,int>(-_Cost[i],i);
+    total += _Cost[i];
+  }
+  sort(cost.begin(),cost.end());
+  for( int i = 0 ; i < tbsize ; i++ ) {
+    _Order[i] = cost[i].second;
+  }
+
+  logout << "Total cost = " << total << " (the longest = " << -cost[0].first << ")" << endl << endl;
+}
+
+//============================================================================//
+void Mpidp::make_Blevel(ofstream &logout)
+// make _Blevel[] (critical path length from each job to the end of DAG)
+//============================================================================//
+{
+  int tbsize = table_size();
+  vector<int> nwait(tbsize);
+  vector<int> order;      // topological order
+
+  make_Cost();
+
+  order.reserve(tbsize);
+  for( int i = 0 ; i < tbsize ; i++ ) {
+    nwait[i] = _JobControl[i].nwait;
+    if( nwait[i] == 0 ) {
+      order.push_back(i);
+    }
+  }
+  for( int k = 0 ; k < order.size() ; k++ ) {
+    int jobid = order[k];
+    for( int i = _Child_ptr[jobid] ; i < _Child_ptr[jobid+1] ; i++ ) {
+      int job_id = _Child_idx[i];
+      if( --nwait[job_id] == 0 ) {
+        order.push_back(job_id);
+      }
+    }
+  }
+  _Topo_order = order;
+
+  if( order.size() < tbsize ) {
+    cerr << "[ERROR] JOB table has circular dependencies!!" << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+
+  // bottom level = own cost + the longest bottom level of depended jobs
+  double cpath = 0.0;
+  _Blevel.assign(tbsize,0.0);
+  for( int k = tbsize-1 ; k >= 0 ; k-- ) {
+    int jobid = order[k];
+    double blevel = 0.0;
+    for( int i = _Child_ptr[jobid] ; i < _Child_ptr[jobid+1] ; i++ ) {
+      blevel = max(blevel,_Blevel[_Child_idx[i]]);
+    }
+    _Blevel[jobid] = _Cost[jobid] + blevel;
+    cpath = max(cpath,_Blevel[jobid]);
+  }
+
+  if( _Priority ) {
+    logout << "Critical path length = " << cpath << endl << endl;
+  }
+}
+
+//============================================================================//
+void Mpidp::resetReadyJobID(int &jobid)
+// reset _JobControl[].ready flag of depended jobs and push them to ready queue
+//============================================================================//
+{
+  for( int i = _Child_ptr[jobid] ; i < _Child_ptr[jobid+1] ; i++ ) {
+    int job_id = _Child_idx[i];
+    if( --_JobControl[job_id].nwait == 0 ) {
+      pushReadyJobID(job_id);
+      update_status(job_id);
+      if( !_Trace_file.empty() ) {
+        _Release.push_back(pair<double,int>(MPI_Wtime() - _Start_time,job_id));
+      }
+    }
+  }
+}
+
+//============================================================================//
+void Mpidp::writeJobControl()
+// write _JobControl[]
+//============================================================================//
+{
+  cout << "jobid taskid ready run done depend depended" << endl;
+  for( int i = 0 ; i < table_size() ; i++ ) {
+    cout << i << " " << _JobControl[i].task_id << " " << _JobControl[i].ready;
+    cout << " " << _JobControl[i].run << " " << _JobControl[i].done << " <";
+    for( int j = _Dep_ptr[i] ; j < _Dep_ptr[i+1] ; j++ ) {
+      cout << _JobControl[_Dep_idx[j]].task_id << ",";
+    }
+    cout << "> <";
+    for( int j = _Child_ptr[i] ; j < _Child_ptr[i+1] ; j++ ) {
+      cout << _JobControl[_Child_idx[j]].task_id << ",";
+    }
+    cout << ">" << endl;
+  }
+}
+
+//============================================================================//
+void Mpidp::make_Id_index(const vector<int> &task_id)
+// make task id -> job id index (flat array or sorted pairs)
+//============================================================================//
+{
+  int tbsize = task_id.size();
+  int id_min = *min_element(task_id.begin(),task_id.end());
+  int id_max = *max_element(task_id.begin(),task_id.end());
+
+  _Id_base = id_min;
+  _Id_index.clear();
+  _Id_sorted.clear();
+
+  if( (double)id_max - id_min < 4.0*tbsize + 1024 ) {
+    // dense task ids : direct index
+    _Id_index.assign(id_max-id_min+1,-1);
+    for( int i = 0 ; i < tbsize ; i++ ) {
+      int &job_id = _Id_index[task_id[i]-id_min];
+      if( job_id != -1 ) {
+        cerr << "[ERROR] Task id [" << task_id[i] << "] is duplicated in table file!!" << endl;
+        MPI_Abort(MPI_COMM_WORLD,1);
+        exit(1);
+      }
+      job_id = i;
+    }
+  }
+  else {
+    // sparse task ids : binary search
+    _Id_sorted.resize(tbsize);
+    for( int i = 0 ; i < tbsize ; i++ ) {
+      _Id_sorted[i] = pair<int,int>(task_id[i],i);
+    }
+    sort(_Id_sorted.begin(),_Id_sorted.end());
+    for( int i = 1 ; i < tbsize ; i++ ) {
+      if( _Id_sorted[i].first == _Id_sorted[i-1].first ) {
+        cerr << "[ERROR] Task id [" << _Id_sorted[i].first << "] is duplicated in table file!!" << endl;
+        MPI_Abort(MPI_COMM_WORLD,1);
+        exit(1);
+      }
+    }
+  }
+}
+
+//============================================================================//
+int Mpidp::task2job(const int task_id)
+// task id -> job id (-1 : not found)
+//============================================================================//
+{
+  if( !_Id_index.empty() ) {
+    long i = (long)task_id - _Id_base;
+    if( i < 0 || i >= _Id_index.size() ) {
+      return -1;
+    }
+    return _Id_index[i];
+  }
+
+  vector<pair<int,int> >::iterator it =
+    lower_bound(_Id_sorted.begin(),_Id_sorted.end(),pair<int,int>(task_id,-1));
+  if( it == _Id_sorted.end() || it->first != task_id ) {
+    return -1;
+  }
+  return it->second;
+}
+
+//============================================================================//
+void Mpidp::clear_JobControl()
+// clear _JobControl
+//============================================================================//
+{
+  for( int i = 0 ; i < table_size() ; i++ ) {
+    _JobControl[i].task_id   = 0;
+    _JobControl[i].ready     = 0;
+    _JobControl[i].run       = 0;
+    _JobControl[i].done      = 0;
+    _JobControl[i].nwait     = 0;
+  }
+}
+
+//============================================================================//
+void Mpidp::initNotRunRank()
+// all ranks in _Member are at run = 0
+//============================================================================//
+{
+  int nbucket = 0;
+  for( int m = 0 ; m < _Member.size() ; m++ ) {
+    nbucket = max(nbucket,capacity(_Member[m]));
+  }
+
+  _Free_rank.assign(nbucket,vector<int>());
+  for( int m = _Member.size()-1 ; m >= 0 ; m-- ) {
+    int i = _Member[m];
+    _Workerlog[i].run = 0;
+    _Workerlog[i].queue = 0;
+    _Workerlog[i].lost = 0;
+    _Workerlog[i].failure = 0;
+    _Free_rank[0].push_back(i);
+  }
+
+  // packing mode : ranks are taken by node (getNodeRank())
+  if( _Pack ) {
+    _Node_rank.assign(_Nnode,deque<int>());
+    _Node_free.assign(_Nnode,0);
+    _Listed.assign(_Host_id.size(),0);
+    for( int m = _Member.size()-1 ; m >= 0 ; m-- ) {
+      int i = _Member[m];
+      _Node_rank[_Host_id[i]].push_back(i);
+      _Node_free[_Host_id[i]] += capacity(i);
+      _Listed[i] = 1;
+    }
+  }
+}
+
+//============================================================================//
+int Mpidp::capacity(const int wid)
+// # of messages queued on a rank (a sub-master keeps 2 or more)
+//   a worker keeps _Prefetch messages for each job slot
+//============================================================================//
+{
+  return (_Weight[wid] > 1) ? max(_Prefetch,2) : _Prefetch * _Slot;
+}
+
+//============================================================================//
+int Mpidp::getNotRunRank()
+// get rank which has the fewest messages (-1 : all ranks are full)
+//============================================================================//
+{
+  for( int n = 0 ; n < _Free_rank.size() ; n++ ) {
+    while( !_Free_rank[n].empty() ) {
+      int wid = _Free_rank[n].back();
+      _Free_rank[n].pop_back();
+
+      // skip an old entry
+      if( _Workerlog[wid].queue != n ) continue;
+
+      if( ++_Workerlog[wid].queue < capacity(wid) ) {
+        _Free_rank[n+1].push_back(wid);
+      }
+      return wid;
+    }
+  }
+
+  return -1;
+}
+
+//============================================================================//
+int Mpidp::getIdleRank()
+// get rank which has no message (-1 : no rank is idle)
+//============================================================================//
+{
+  while( !_Free_rank[0].empty() ) {
+    int wid = _Free_rank[0].back();
+    if( _Workerlog[wid].queue == 0 ) {
+      return getNotRunRank();
+    }
+    _Free_rank[0].pop_back();    // an old entry
+  }
+
+  return -1;
+}
+
+//============================================================================//
+void Mpidp::make_Node(map<string,int> &node)
+// node of each rank under the master by host name (without domain)
+//============================================================================//
+{
+  int nproc = _Host.size();
+
+  node.clear();
+  _Host_id.assign(nproc,-1);
+  for( int m = 0 ; m < _Member.size() ; m++ ) {
+    int i = _Member[m];
+    string h = _Host[i].substr(0,_Host[i].find('.'));
+    if( node.find(h) == node.end() ) {
+      int n = node.size();
+      node[h] = n;
+    }
+    _Host_id[i] = node[h];
+  }
+  _Nnode = node.size();
+}
+
+//============================================================================//
+void Mpidp::make_Host_queue(const vector<int> &todo)
+// queues of jobs for each node (-hc : host names separated by comma)
+//   a host name matches with or without the domain name
+//   jobs for no node (no host name or a host without ranks) are in the last queue
+//============================================================================//
+{
+  map<string,int> node;      // host name without domain -> node
+
+  make_Node(node);
+
+  _Host_queue.assign(node.size()+1,deque<int>());
+  _Host_since.assign(node.size()+1,MPI_Wtime());
+  _Taken.assign(table_size(),0);
+
+  for( int k = 0 ; k < todo.size() ; k++ ) {
+    string hint = table_column(todo[k],_Host_column);
+    int nhost = 0;
+    for( size_t pos = 0 ; pos < hint.size() ; ) {
+      size_t end = hint.find(',',pos);
+      if( end == string::npos ) {
+        end = hint.size();
+      }
+      string h = hint.substr(pos,end-pos);
+      h = h.substr(0,h.find('.'));
+      pos = end + 1;
+
+      map<string,int>::iterator it = node.find(h);
+      if( it != node.end() ) {
+        _Host_queue[it->second].push_back(todo[k]);
+        nhost++;
+      }
+    }
+    if( nhost == 0 ) {
+      _Host_queue.back().push_back(todo[k]);
+    }
+  }
+}
+
+//============================================================================//
+int Mpidp::local_job(const int wid,const double now)
+// a job for the rank (-1 : none until _Wakeup)
+//   jobs for its node, then jobs for no node, and then jobs for other nodes
+//   which waited _Host_delay sec. at the head of their queue
+//============================================================================//
+{
+  int nnode = _Host_queue.size() - 1;
+  int own[2] = { _Host_id[wid], nnode };
+
+  // sent jobs are removed from the head of each queue
+  for( int q = 0 ; q <= nnode ; q++ ) {
+    while( !_Host_queue[q].empty() && _Taken[_Host_queue[q].front()] ) {
+      _Host_queue[q].pop_front();
+      _Host_since[q] = now;
+    }
+  }
+
+  for( int k = 0 ; k < 2 ; k++ ) {
+    int q = own[k];
+    if( q >= 0 && !_Host_queue[q].empty() ) {
+      int jobid = _Host_queue[q].front();
+      _Host_queue[q].pop_front();
+      _Host_since[q] = now;
+      _Taken[jobid] = 1;
+      return jobid;
+    }
+  }
+
+  for( int q = 0 ; q < nnode ; q++ ) {
+    if( _Host_queue[q].empty() ) continue;
+    if( now - _Host_since[q] >= _Host_delay ) {
+      int jobid = _Host_queue[q].front();
+      _Host_queue[q].pop_front();
+      _Host_since[q] = now;
+      _Taken[jobid] = 1;
+      return jobid;
+    }
+    if( _Wakeup == 0.0 || _Host_since[q] + _Host_delay < _Wakeup ) {
+      _Wakeup = _Host_since[q] + _Host_delay;
+    }
+  }
+
+  return -1;
+}
+
+//============================================================================//
+int Mpidp::getLocalRank(vector<int> &chunk,const int remain,const int nworker)
+// get rank which has the fewest messages and a job to run (-1 : none)
+//   chunk : jobs for the rank (-hc)
+//============================================================================//
+{
+  vector<int> parked;      // ranks without jobs
+  double now = MPI_Wtime();
+  int wid;
+
+  _Wakeup = 0.0;
+  chunk.clear();
+  while( (wid = getNotRunRank()) != -1 ) {
+    int jobid = local_job(wid,now);
+    if( jobid >= 0 ) {
+      chunk.push_back(jobid);
+      break;
+    }
+    parked.push_back(wid);
+  }
+
+  // the chunk size is taken only for the rank chosen (-cm 2 counts chunks)
+  if( wid != -1 ) {
+    int nslot = (_Weight[wid] > 1) ? _Weight[wid] * _Slot : 1;
+    int n = 0;
+    for( int w = 0 ; w < nslot && n < remain ; w++ ) {
+      n += chunk_size(remain-n,nworker);
+    }
+
+    int jobid;
+    while( chunk.size() < n && (jobid = local_job(wid,now)) >= 0 ) {
+      chunk.push_back(jobid);
+    }
+  }
+
+  for( int k = 0 ; k < parked.size() ; k++ ) {
+    putNotRunRank(parked[k]);
+  }
+  if( wid != -1 ) {
+    _Wakeup = 0.0;
+  }
+
+  return wid;
+}
+
+//============================================================================//
+void Mpidp::make_Pack(ofstream &logout)
+// cores and memory of each job and node (-rc, -rm, -nc, -nm)
+//   a node has one core per job slot of its ranks unless -nc is given
+//============================================================================//
+{
+  map<string,int> node;
+  int tbsize = table_size();
+
+  make_Node(node);
+
+  _Free_core.assign(_Nnode,0);
+  _Free_mem.assign(_Nnode,_Node_mem);
+  for( int m = 0 ; m < _Member.size() ; m++ ) {
+    int i = _Member[m];
+    _Free_core[_Host_id[i]] += (_Node_core > 0) ? 0 : _Weight[i] * _Slot;
+  }
+  if( _Node_core > 0 ) {
+    _Free_core.assign(_Nnode,_Node_core);
+  }
+  int maxcore = (_Nnode > 0) ? *max_element(_Free_core.begin(),_Free_core.end()) : 0;
+
+  _Job_core.assign(tbsize,1);
+  _Job_mem.assign(tbsize,0.0);
+  _Job_node.assign(tbsize,-1);
+  for( int i = 0 ; i < tbsize ; i++ ) {
+    if( _Core_column > 0 ) {
+      string s = table_column(i,_Core_column);
+      _Job_core[i] = s.empty() ? 1 : atoi(s.c_str());
+    }
+    if( _Mem_column > 0 ) {
+      _Job_mem[i] = atof(table_column(i,_Mem_column).c_str());
+    }
+    if( _Job_core[i] < 1 || _Job_core[i] > maxcore ||
+        (_Node_mem > 0.0 && _Job_mem[i] > _Node_mem) ) {
+      cerr << "[ERROR] JOB " << i+1 << " needs " << _Job_core[i] << " cores and "
+           << _Job_mem[i] << " MB, more than a node (" << maxcore << " cores and "
+           << _Node_mem << " MB)!!" << endl;
+      MPI_Abort(MPI_COMM_WORLD,1);
+      exit(1);
+    }
+  }
+  _Pack_head = -1;
+  _Pack_reserve = -1;
+  _Pack = 1;
+
+  logout << "Packed nodes (cores/memory MB) :";
+  for( map<string,int>::iterator it = node.begin() ; it != node.end() ; ++it ) {
+    logout << "  " << it->first << "(" << _Free_core[it->second] << "/";
+    if( _Node_mem > 0.0 ) {
+      logout << _Node_mem << ")";
+    }
+    else {
+      logout << "-)";
+    }
+  }
+  logout << endl << endl;
+}
+
+//============================================================================//
+int Mpidp::fit_Node(const int jobid)
+// node with a free rank where the job fits best (the fewest cores left)
+//   (-1 : the job fits no node)
+//============================================================================//
+{
+  int best = -1;
+
+  for( int n = 0 ; n < _Nnode ; n++ ) {
+    if( _Node_free[n] <= 0 || _Free_core[n] < _Job_core[jobid] ) continue;
+    if( _Node_mem > 0.0 && _Free_mem[n] < _Job_mem[jobid] ) continue;
+    if( n == _Pack_reserve && jobid != _Pack_head ) continue;
+    if( best < 0 || _Free_core[n] < _Free_core[best] ) {
+      best = n;
+    }
+  }
+
+  return best;
+}
+
+//============================================================================//
+int Mpidp::getPackRank(vector<int> &chunk)
+// get rank on a node where the first fitting job of _Pack_queue fits
+//   (-1 : no job fits now)
+//   chunk : the job for the rank (-rc, -rm)
+//   when the first job fits no node, the node with the most free cores is
+//   reserved for it, so that wide jobs are not passed by narrow jobs forever
+//============================================================================//
+{
+  const int window = 1000;    // jobs looked at in one call
+  int nfree = 0;
+
+  for( int n = 0 ; n < _Nnode ; n++ ) {
+    nfree += _Node_free[n];
+  }
+
+  // the reserved job was sent or lost its place
+  if( _Pack_queue.empty() || _Pack_queue.front() != _Pack_head ) {
+    _Pack_head = -1;
+    _Pack_reserve = -1;
+  }
+
+  int wid = -1;
+  chunk.clear();
+  for( int k = 0 ; k < _Pack_queue.size() && k < window && nfree > 0 ; k++ ) {
+    int jobid = _Pack_queue[k];
+    int n = fit_Node(jobid);
+
+    if( n >= 0 ) {
+      wid = getNodeRank(n);
+      chunk.push_back(jobid);
+      _Pack_queue.erase(_Pack_queue.begin()+k);
+      _Job_node[jobid] = n;
+      _Free_core[n] -= _Job_core[jobid];
+      _Free_mem[n] -= _Job_mem[jobid];
+      break;
+    }
+    if( k == 0 && _Pack_head < 0 ) {
+      _Pack_head = jobid;
+      for( int m = 0 ; m < _Nnode ; m++ ) {
+        if( _Pack_reserve < 0 || _Free_core[m] > _Free_core[_Pack_reserve] ) {
+          _Pack_reserve = m;
+        }
+      }
+    }
+  }
+
+  return wid;
+}
+
+//============================================================================//
+int Mpidp::getNodeRank(const int node)
+// get rank on the node which can take a message (-1 : all ranks are full)
+//   ranks take turns, so that messages are spread over the ranks
+//   full and lost ranks leave _Node_rank[] when they are found
+//============================================================================//
+{
+  deque<int> &list = _Node_rank[node];
+
+  while( !list.empty() ) {
+    int wid = list.back();
+    list.pop_back();
+    if( _Workerlog[wid].queue < 0 || _Workerlog[wid].queue >= capacity(wid) ) {
+      _Listed[wid] = 0;
+      continue;
+    }
+    if( ++_Workerlog[wid].queue < capacity(wid) ) {
+      list.push_front(wid);
+    }
+    else {
+      _Listed[wid] = 0;
+    }
+    _Node_free[node] --;
+    return wid;
+  }
+
+  return -1;
+}
+
+//============================================================================//
+void Mpidp::release_Pack(const int jobid)
+// cores and memory of a returned job are free
+//============================================================================//
+{
+  int n = _Job_node[jobid];
+
+  if( n >= 0 ) {
+    _Free_core[n] += _Job_core[jobid];
+    _Free_mem[n] += _Job_mem[jobid];
+    _Job_node[jobid] = -1;
+  }
+}
+
+//============================================================================//
+void Mpidp::putNotRunRank(const int wid)
+// a message of the rank was returned
+//============================================================================//
+{
+  if( _Pack ) {
+    int n = _Host_id[wid];
+    _Workerlog[wid].queue --;
+    _Node_free[n] ++;
+    if( !_Listed[wid] ) {
+      _Node_rank[n].push_back(wid);
+      _Listed[wid] = 1;
+    }
+    return;
+  }
+
+  _Free_rank[--_Workerlog[wid].queue].push_back(wid);
+}
+
+//============================================================================//
+void Mpidp::dispatch(const int wid,const int *jobid,const int njob,const int retry)
+// send jobs to a worker and record them in _Namelog[] and _Workerlog[]
+//============================================================================//
+{
+  double now = MPI_Wtime();
+
+  for( int k = 0 ; k < njob ; k++ ) {
+    _Namelog[jobid[k]].worker.push_back(wid);
+    _Namelog[jobid[k]].rcode[0].push_back(0);
+    _Namelog[jobid[k]].rcode[1].push_back(-1);
+    _Namelog[jobid[k]].rcode[2].push_back(0);
+    _Namelog[jobid[k]].rcode[3].push_back(0);
+    _Namelog[jobid[k]].time[0].push_back(now - _Start_time);
+    _Namelog[jobid[k]].time[1].push_back(-1.0);
+    _Namelog[jobid[k]].time[2].push_back(-1.0);
+    for( int u = 0 ; u < 4 ; u++ ) {
+      _Namelog[jobid[k]].usage[u].push_back(0);
+    }
+    _Workerlog[wid].name.push_back(_Namelog[jobid[k]].name);
+    _Workerlog[wid].jobid.push_back(jobid[k]);
+    _Workerlog[wid].rcode.push_back(0);
+    update_status(jobid[k]);
+  }
+
+  // jobs queued on a rank are run one after another
+  if( _Workerlog[wid].run == 0 ) {
+    _Workerlog[wid].heard = now;
+    _Workerlog[wid].deadline = now;
+  }
+  _Workerlog[wid].deadline += _Deadline * njob;
+  _Workerlog[wid].run += njob;
+
+  send_job(wid,jobid,njob,retry);
+}
+
+//============================================================================//
+void Mpidp::finish_Workerlog(const int wid,const int jobid)
+// a job of the rank was returned
+//============================================================================//
+{
+  for( int i = _Workerlog[wid].name.size()-1 ; i >= 0 ; i-- ) {
+    if( _Workerlog[wid].rcode[i] == 0 && _Workerlog[wid].jobid[i] == jobid ) {
+      _Workerlog[wid].rcode[i] = 1;
+      break;
+    }
+  }
+  _Workerlog[wid].run--;
+}
+
+//============================================================================//
+void Mpidp::make_Hierarchy(int argc,char *argv[],const int &nproc,const int &myid,
+                           char *hostall,ofstream &logout)
+// parent rank and member ranks of each rank (-hm n : n sub-masters per node)
+//============================================================================//
+{
+  vector<int> parent(nproc,0);    // rank which sends jobs to rank i
+
+  if( myid == 0 ) {
+    _Host.resize(nproc);
+    for( int i = 0 ; i < nproc ; i++ ) {
+      _Host[i] = &hostall[i*MPI_MAX_PROCESSOR_NAME];
+    }
+  }
+
+  _Hierarchy = 0;
+  for( int i = 1 ; i < argc ; i++ ) {
+    if( !strcmp(argv[i],"-hm") && i+1 < argc ) {
+      _Hierarchy = atoi(argv[++i]);
+    }
+  }
+
+  if( _Hierarchy > 0 ) {
+    if( myid == 0 ) {
+      // worker ranks on each node
+      vector<string> host;
+      vector<vector<int> > node;
+      for( int i = 1 ; i < nproc ; i++ ) {
+        string h = &hostall[i*MPI_MAX_PROCESSOR_NAME];
+        int n = find(host.begin(),host.end(),h) - host.begin();
+        if( n == host.size() ) {
+          host.push_back(h);
+          node.push_back(vector<int>());
+        }
+        node[n].push_back(i);
+      }
+
+      // the first rank of each group is a sub-master (2 or more workers)
+      int nsub = 0;
+      for( int n = 0 ; n < node.size() ; n++ ) {
+        int gsize = (node[n].size() + _Hierarchy - 1) / _Hierarchy;
+        for( int g = 0 ; g < node[n].size() ; g += gsize ) {
+          int gend = min(g+gsize,(int)node[n].size());
+          if( gend - g < 3 ) continue;
+          for( int k = g+1 ; k < gend ; k++ ) {
+            parent[node[n][k]] = node[n][g];
+          }
+          nsub++;
+        }
+      }
+      logout << "#Sub-master = " << nsub << endl << endl;
+    }
+
+    MPI_Bcast(&parent[0],nproc,MPI_INT,0,MPI_COMM_WORLD);
+  }
+
+  _Parent = parent[myid];
+  _Member.clear();
+  _Weight.assign(nproc,0);
+  for( int i = 1 ; i < nproc ; i++ ) {
+    if( parent[i] == myid ) {
+      _Member.push_back(i);
+    }
+    _Weight[parent[i]] ++;
+  }
+  for( int i = 1 ; i < nproc ; i++ ) {
+    if( _Weight[i] == 0 ) _Weight[i] = 1;    // a worker
+  }
+}
+
+//============================================================================//
+int Mpidp::isSubmaster()
+// this rank schedules node-local workers
+//============================================================================//
+{
+  return _Parent == 0 && !_Member.empty();
+}
 
 //============================================================================//
-string Mpidp::replace_pattern(const string &pattern, const string &position, const string &option) {
-// the pattern of a character is replaced 
+void Mpidp::read_journal(ofstream &logout)
+// read the journal of a previous run and mark finished jobs in _Done[]
+//   a job is finished if RET = 0 (and FILE = 1 for -ot)
 //============================================================================//
-  string  command;
-  int  pos_before = 0;
-  int  pos = 0;
-  int  len = position.size();
-  
-  while( (pos = pattern.find(position, pos)) != std::string::npos) {
-    command.append(pattern, pos_before, pos - pos_before);
-    command.append(option);
-    pos += len;
-    pos_before = pos;
+{
+  ifstream Input(_Journal_file.c_str(),ios::in);
+  if( !Input ) {
+    logout << "Journal [" << _Journal_file << "] was not found. All jobs are run." << endl << endl;
+    return;
   }
 
-  command.append(pattern, pos_before, pattern.size() - pos_before);
+  string line;
+  int njob = -1;
+  int jobno, ret, file;
 
-  return command;
+  while( getline(Input,line) ) {
+    if( line.empty() ) continue;
+    if( line[0] == '#' ) {      // header : #MPIDP journal <TAB> # of jobs
+      sscanf(line.c_str(),"#MPIDP journal\t%d",&njob);
+      continue;
+    }
+    // a broken last line is ignored
+    if( sscanf(line.c_str(),"%d\t%d\t%d",&jobno,&ret,&file) != 3 ||
+        jobno < 1 || jobno > _Done.size() ) continue;
+
+    if( ret == 0 && (file == 1 || _Out_option == 0) && !_Done[jobno-1] ) {
+      _Done[jobno-1] = 1;
+      _Ndone ++;
+    }
+  }
+
+  if( njob != _Done.size() ) {
+    cerr << "[ERROR] Journal [" << _Journal_file << "] is not for table file [" << _Table_file << "]!!" << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
+
+  logout << "#Finished JOB in journal = " << _Ndone << endl << endl;
 }
 
 //============================================================================//
-void Mpidp::write_table(const int &nproc,ofstream &logout)
-// write JOB and Workers report
+void Mpidp::open_journal()
+// open the journal for append (a new journal unless restart)
 //============================================================================//
 {
-  // JOB table
-  logout << "JOB table :" << endl;
+  int flags = O_WRONLY | O_CREAT | O_APPEND;
+  struct stat buf;
 
-  for( int i = 0 ; i < _Table_list.size() ; i++ ) {
-    logout << _Namelog[i].name << " EXEC=" << _Namelog[i].exec;
+  if( _Journal_file.empty() ) return;
 
-    for( int j = 0 ; j < _Namelog[i].worker.size() ; j++ ) {
-      logout << " (WID=" << _Namelog[i].worker[j];
-      logout << " END=" << _Namelog[i].rcode[0][j];
-      logout << " RET=" << _Namelog[i].rcode[1][j];
-      logout << " FILE=" << _Namelog[i].rcode[2][j] << ")";
-    }
-    logout << endl;
+  if( !_Restart ) {
+    flags |= O_TRUNC;
   }
 
-  // Worker table
-  logout << "\nWorker table :" << endl;
+  _Journal_fd = open(_Journal_file.c_str(),flags,0644);
+  if( _Journal_fd < 0 ) {
+    cerr << "[ERROR] Journal [" << _Journal_file << "] was not opened!!" << endl;
+    MPI_Abort(MPI_COMM_WORLD,1);
+    exit(1);
+  }
 
-  for( int i = 1 ; i < nproc ; i++ ) {
-    logout << i << "\t" << _Workerlog[i].name.size();
+  _Journal_buf.clear();
+  _Journal_nsync = 0;
+  _Journal_time = MPI_Wtime();
 
-    for( int j = 0 ; j < _Workerlog[i].name.size() ; j++ ) {
-      logout << "\t" << _Workerlog[i].name[j] << "\t" << _Workerlog[i].rcode[j];
+  if( fstat(_Journal_fd,&buf) == 0 && buf.st_size == 0 ) {
+    ostringstream head;
+    head << "#MPIDP journal\t" << table_size() << "\n";
+    _Journal_buf = head.str();
+    flush_journal(1);
+  }
+  else {
+    // a broken last line of a previous run is terminated
+    char last = '\n';
+    int fd = open(_Journal_file.c_str(),O_RDONLY);
+    if( fd >= 0 ) {
+      if( pread(fd,&last,1,buf.st_size-1) != 1 ) last = '\n';
+      close(fd);
+    }
+    if( last != '\n' ) {
+      _Journal_buf = "\n";
     }
-    logout << endl;
   }
+}
 
-  delete [] _Workerlog;
-  delete [] _Namelog;
+//============================================================================//
+void Mpidp::write_journal(const int jobid,const int ret,const int file)
+// append a finished job to the journal
+//   records are written while waiting for results, and synced in batches
+//============================================================================//
+{
+  char record[64];
 
-  return;
+  if( _Journal_fd < 0 ) return;
+
+  sprintf(record,"%d\t%d\t%d\n",jobid+1,ret,file);
+  _Journal_buf += record;
+  _Journal_nsync ++;
+
+  if( _Journal_nsync >= 1024 || MPI_Wtime() - _Journal_time >= 1.0 ) {
+    flush_journal(1);
+  }
 }
 
 //============================================================================//
-int Mpidp::getNextReadyJobID()
-//  Get next ready Job id
+void Mpidp::flush_journal(const int sync)
+// write records to the journal (sync = 1 : and fsync)
 //============================================================================//
 {
-  int jobid = -1;
+  size_t pos = 0;
 
-  for( int i = 0 ; i < _Table_list.size() ; i++ ) {
-    if( _JobControl[i].ready == 1 &&  _JobControl[i].done == 0 && _JobControl[i].run == 0 ) {
-      jobid = i;
+  while( pos < _Journal_buf.size() ) {
+    ssize_t n = write(_Journal_fd,_Journal_buf.data()+pos,_Journal_buf.size()-pos);
+    if( n < 0 ) {
+      cerr << "[WARNING] Journal [" << _Journal_file << "] was not written." << endl;
+      break;
     }
+    pos += n;
+  }
+  _Journal_buf.clear();
+
+  if( sync ) {
+    fsync(_Journal_fd);
+    _Journal_nsync = 0;
+    _Journal_time = MPI_Wtime();
   }
-  return jobid;
 }
 
 //============================================================================//
-void Mpidp::resetReadyJobID(int &jobid)
-// reset _JobControl[].ready flag
+void Mpidp::close_journal()
+// sync and close the journal
+//============================================================================//
+{
+  if( _Journal_fd < 0 ) return;
+
+  flush_journal(1);
+  close(_Journal_fd);
+  _Journal_fd = -1;
+}
+
+//============================================================================//
+void Mpidp::make_Uptodate(ofstream &logout)
+// mark jobs with up-to-date output in _Done[] (-mk 1)
 //============================================================================//
 {
-  for( int i = 0 ; i < _JobControl[jobid].depended.size() ; i++ ) {
-    int task_id = _JobControl[jobid].depended[i];
-    int job_id = _jobid_map[task_id];
-    if( checkDependTaskID(job_id) ) {
-      _JobControl[job_id].ready = 1;
+  int nskip = 0;
+  int tbsize = table_size();
+
+  for( int k = 0 ; k < tbsize ; k++ ) {
+    int jobid = _Job_order ? _Topo_order[k] : k;
+    if( !_Done[jobid] && isUptodate(jobid) ) {
+      _Done[jobid] = 1;
+      _Ndone ++;
+      nskip ++;
     }
   }
+
+  _Mtime.clear();
+  logout << "#Up-to-date JOB = " << nskip << endl << endl;
 }
 
 //============================================================================//
-int Mpidp::checkDependTaskID(int &jobid)
-// check _JobControl[].depend ids whether done(1) all or not(0).
+int Mpidp::isUptodate(const int jobid)
+// output file exists and is newer than input files
+//   (and than output files of depend jobs, which must not be run again)
 //============================================================================//
 {
-  int ret = 1;
+  string out = table_column(jobid,_Out_option);
+  double tout = file_mtime(out);
+
+  if( out.empty() || tout < 0.0 ) {
+    return 0;
+  }
+
+  for( int c = 0 ; c < _In_column.size() ; c++ ) {
+    string in = table_column(jobid,_In_column[c]);
+    for( size_t pos = 0 ; pos < in.size() ; ) {
+      size_t end = in.find(',',pos);
+      if( end == string::npos ) {
+        end = in.size();
+      }
+      if( end > pos ) {
+        double tin = file_mtime(in.substr(pos,end-pos));
+        if( tin < 0.0 || tin > tout ) {
+          return 0;
+        }
+      }
+      pos = end + 1;
+    }
+  }
 
-  for( int i = 0 ; i < _JobControl[jobid].depend.size() ; i++ ) {
-    int task_id = _JobControl[jobid].depend[i];
-    int job_id = _jobid_map[task_id];
-    int done = _JobControl[job_id].done;
-    ret = ret * done;
-    if(done == 0) break;
+  if( _Job_order ) {
+    for( int i = _Dep_ptr[jobid] ; i < _Dep_ptr[jobid+1] ; i++ ) {
+      int job_id = _Dep_idx[i];
+      if( !_Done[job_id] ) {
+        return 0;
+      }
+      if( file_mtime(table_column(job_id,_Out_option)) > tout ) {
+        return 0;
+      }
+    }
   }
-  return ret;
+
+  return 1;
 }
 
 //============================================================================//
-void Mpidp::writeJobControl()
-// write _JobControl[]
+double Mpidp::file_mtime(const string &file)
+// modification time of a file (-1 : not found)
 //============================================================================//
 {
-  cout << "jobid taskid ready run done depend depended" << endl;
-  for( int i = 0 ; i < _Table_list.size() ; i++ ) {
-    cout << i << " " << _JobControl[i].task_id << " " << _JobControl[i].ready;
-    cout << " " << _JobControl[i].run << " " << _JobControl[i].done << " <";
-    for( int j = 0 ; j < _JobControl[i].depend.size() ; j++ ) {
-      cout << _JobControl[i].depend[j] << ",";
+  map<string,double>::iterator it = _Mtime.find(file);
+  if( it != _Mtime.end() ) {
+    return it->second;
+  }
+
+  struct stat buf;
+  double mtime = -1.0;
+  if( !file.empty() && stat(file.c_str(),&buf) == 0 ) {
+    mtime = buf.st_mtim.tv_sec + buf.st_mtim.tv_nsec * 1.0e-9;
+  }
+  _Mtime[file] = mtime;
+
+  return mtime;
+}
+
+//============================================================================//
+void Mpidp::split_columns(const string &col,vector<int> &column)
+// column numbers separated by comma (-ic 2,3)
+//============================================================================//
+{
+  for( size_t pos = 0 ; pos < col.size() ; pos++ ) {
+    column.push_back(atoi(&col[pos]));
+    pos = col.find(',',pos);
+    if( pos == string::npos ) break;
+  }
+}
+
+//============================================================================//
+void Mpidp::worker_option(int argc,char *argv[])
+// MPIDP options used by workers and sub-masters (-ch, -ic, -hb, -bk, -st, -si)
+//============================================================================//
+{
+  _Cache_dir = "";
+  _In_column.clear();
+  _Heartbeat = 0.0;
+  _Backup = 0;
+  _Watch = 0;
+  int status = 0;
+  double interval = 10.0;
+
+  for( int i = 1 ; i < argc-1 ; i++ ) {
+    if( !strcmp(argv[i],"-hb") ) {
+      _Heartbeat = atof(argv[++i]);
     }
-    cout << "> <";
-    for( int j = 0 ; j < _JobControl[i].depended.size() ; j++ ) {
-      cout << _JobControl[i].depended[j] << ",";
+    else if( !strcmp(argv[i],"-st") ) {
+      status = 1;
+      i++;
     }
-    cout << ">" << endl;
+    else if( !strcmp(argv[i],"-si") ) {
+      interval = atof(argv[++i]);
+    }
+    else if( !strcmp(argv[i],"-ch") ) {
+      _Cache_dir = argv[++i];
+    }
+    else if( !strcmp(argv[i],"-ic") ) {
+      split_columns(argv[++i],_In_column);
+    }
+    else if( !strcmp(argv[i],"-bk") ) {
+      _Backup = atoi(argv[++i]);
+    }
+  }
+
+  // heartbeats are the ticks for status snapshots of master without -hb
+  if( _Heartbeat <= 0.0 && status ) {
+    _Heartbeat = interval;
+  }
+
+  if( !_Cache_dir.empty() && _Out_option > 0 ) {
+    mkdir(_Cache_dir.c_str(),0755);    // a local directory on each node
+  }
+  else {
+    _Cache_dir = "";
   }
 }
 
 //============================================================================//
-int Mpidp::count_comma(const string &s0)
-// Count comma
+void Mpidp::make_Same(ofstream &logout)
+// link jobs with the same table line (-ch), which are run only once
 //============================================================================//
 {
-  int n = 0;
-  string s1;
+  map<string,int> last;     // table line -> last job with the line
+  int nsame = 0;
 
-  s1 = s0;
-  while(1) {
-    size_t i = s1.rfind(',', s1.length());
-    if (i != string::npos) {
-      s1 = s1.substr(0, i);
-      n++;
+  for( int i = 0 ; i < table_size() ; i++ ) {
+    if( _Done[i] ) continue;
+
+    string line = table_line(i);
+    map<string,int>::iterator it = last.find(line);
+    if( it == last.end() ) {
+      last[line] = i;
     }
     else {
+      _Same[it->second] = i;
+      it->second = i;
+      nsame ++;
+    }
+  }
+
+  logout << "#Duplicated JOB = " << nsame << endl << endl;
+}
+
+//============================================================================//
+void Mpidp::hash_data(unsigned long long &h,const char *data,const size_t len)
+// 64-bit FNV-1a hash
+//============================================================================//
+{
+  for( size_t i = 0 ; i < len ; i++ ) {
+    h ^= (unsigned char)data[i];
+    h *= 1099511628211ULL;
+  }
+}
+
+//============================================================================//
+string Mpidp::cache_key(const string &command,const string &line)
+// result cache key : hash of the expanded command line and input files
+//============================================================================//
+{
+  unsigned long long h = 14695981039346656037ULL;
+  vector<char> buf(65536);
+  char key[32];
+
+  hash_data(h,command.c_str(),command.size()+1);
+
+  for( int c = 0 ; c < _In_column.size() ; c++ ) {
+    string in = get_column(line,_In_column[c]);
+    for( size_t pos = 0 ; pos < in.size() ; ) {
+      size_t end = in.find(',',pos);
+      if( end == string::npos ) {
+        end = in.size();
+      }
+      string file = in.substr(pos,end-pos);
+      pos = end + 1;
+      if( file.empty() ) continue;
+
+      hash_data(h,file.c_str(),file.size()+1);
+      ifstream Input(file.c_str(),ios::in | ios::binary);
+      if( !Input ) {
+        hash_data(h,"\0",1);    // not found
+        continue;
+      }
+      while( Input.read(&buf[0],buf.size()) || Input.gcount() > 0 ) {
+        hash_data(h,&buf[0],Input.gcount());
+        send_heartbeat(1);    // a large input file (-hb)
+      }
+    }
+  }
+
+  sprintf(key,"%016llx",h);
+  return key;
+}
+
+//============================================================================//
+int Mpidp::read_cache(const string &key,const string &out_file,int &ret)
+// copy the cached output file of key (1 : hit, 0 : miss)
+//============================================================================//
+{
+  string path = _Cache_dir + "/" + key;
+  ifstream Input((path + ".ret").c_str(),ios::in);
+
+  if( !Input || !(Input >> ret) ) {
+    return 0;
+  }
+
+  return copy_file(path + ".out",out_file);
+}
+
+//============================================================================//
+void Mpidp::write_cache(const string &key,const string &out_file,const int ret)
+// store the output file and RET of key
+//   .ret is renamed last, so that a hit always has a complete .out
+//============================================================================//
+{
+  string path = _Cache_dir + "/" + key;
+  char tmp[32];
+
+  sprintf(tmp,".%d",(int)getpid());
+  if( !copy_file(out_file,path + ".out" + tmp) ||
+      rename((path + ".out" + tmp).c_str(),(path + ".out").c_str()) != 0 ) {
+    unlink((path + ".out" + tmp).c_str());
+    return;
+  }
+
+  ofstream Output((path + ".ret" + tmp).c_str(),ios::out);
+  Output << ret << endl;
+  Output.close();
+  if( !Output || rename((path + ".ret" + tmp).c_str(),(path + ".ret").c_str()) != 0 ) {
+    unlink((path + ".ret" + tmp).c_str());
+  }
+}
+
+//============================================================================//
+int Mpidp::copy_file(const string &src,const string &dst)
+// copy a file (1 : success)
+//============================================================================//
+{
+  ifstream Input(src.c_str(),ios::in | ios::binary);
+  if( !Input ) {
+    return 0;
+  }
+
+  ofstream Output(dst.c_str(),ios::out | ios::binary | ios::trunc);
+  if( !Output ) {
+    return 0;
+  }
+
+  // heartbeats are sent while a large file is copied (-hb)
+  vector<char> buf(65536);
+  while( Input.read(&buf[0],buf.size()) || Input.gcount() > 0 ) {
+    Output.write(&buf[0],Input.gcount());
+    send_heartbeat(1);
+  }
+  Output.close();
+
+  return Output ? 1 : 0;
+}
+
+//============================================================================//
+double Mpidp::next_Due()
+// the earliest time recv_result() has work while no message comes
+//   (-1 : none, and recv_result() blocks in MPI_Probe)
+//============================================================================//
+{
+  double due = (_Wakeup > 0.0) ? _Wakeup : -1.0;
+
+  if( !_Status_file.empty() ) {
+    double t = (_Status_time >= 0.0) ? _Start_time + _Status_time + _Status_interval : MPI_Wtime();
+    due = (due < 0.0) ? t : min(due,t);
+  }
+
+  for( int m = 0 ; m < _Member.size() && _Watch ; m++ ) {
+    int i = _Member[m];
+    if( _Workerlog[i].lost || _Workerlog[i].run == 0 ) continue;
+
+    if( _Heartbeat > 0.0 ) {
+      double t = _Workerlog[i].heard + 3.0 * _Heartbeat;
+      due = (due < 0.0) ? t : min(due,t);
+    }
+    if( _Deadline > 0.0 ) {
+      due = (due < 0.0) ? _Workerlog[i].deadline : min(due,_Workerlog[i].deadline);
+    }
+  }
+
+  return due;
+}
+
+//============================================================================//
+int Mpidp::check_Worker()
+// find a rank with jobs which is silent for 3 heartbeats or over the deadline
+//   (0 : all ranks are alive)
+//============================================================================//
+{
+  double now = MPI_Wtime();
+
+  for( int m = 0 ; m < _Member.size() ; m++ ) {
+    int i = _Member[m];
+    if( _Workerlog[i].lost || _Workerlog[i].run == 0 ) continue;
+
+    if( _Heartbeat > 0.0 && now - _Workerlog[i].heard > 3.0 * _Heartbeat ) {
+      cerr << "[WARNING] Worker " << i << " sent no heartbeat for "
+           << now - _Workerlog[i].heard << " sec." << endl;
+      return i;
+    }
+    if( _Deadline > 0.0 && now > _Workerlog[i].deadline ) {
+      cerr << "[WARNING] Jobs on worker " << i << " are over the deadline." << endl;
+      return i;
+    }
+  }
+
+  return 0;
+}
+
+//============================================================================//
+int Mpidp::lost_Worker(const int wid,deque<int> &jobs)
+// the rank gets no more jobs, and its jobs are pushed to jobs
+//   (return # of messages not returned)
+//============================================================================//
+{
+  int nqueue = _Workerlog[wid].queue;
+  int first = jobs.size();
+
+  for( int i = 0 ; i < _Workerlog[wid].jobid.size() ; i++ ) {
+    if( _Workerlog[wid].rcode[i] == 0 ) {
+      _Workerlog[wid].rcode[i] = -1;
+      jobs.push_back(_Workerlog[wid].jobid[i]);
+    }
+  }
+  cerr << "[WARNING] Worker " << wid << " was lost. " << _Workerlog[wid].run
+       << " jobs are sent to other workers." << endl;
+
+  if( _Pack ) {
+    _Node_free[_Host_id[wid]] -= capacity(wid) - nqueue;
+  }
+
+  _Workerlog[wid].lost = 1;
+  _Workerlog[wid].run = 0;
+  _Workerlog[wid].queue = -1;    // never taken by getNotRunRank()
+  _Nlost ++;
+  for( int k = first ; k < jobs.size() ; k++ ) {
+    update_status(jobs[k]);
+  }
+
+  return nqueue;
+}
+
+//============================================================================//
+void Mpidp::set_Namelog(const int wid,const int *ir)
+// results of the latest run of the job on the rank
+//   (the job started the wall time before the result was received)
+//============================================================================//
+{
+  NameLog &log = _Namelog[ir[0]];
+  double now = MPI_Wtime() - _Start_time;
+
+  for( int i = log.worker.size()-1 ; i >= 0 ; i-- ) {
+    if( log.worker[i] == wid ) {
+      log.rcode[0][i] = 1;
+      log.rcode[1][i] = ir[1];
+      log.rcode[2][i] = ir[2];
+      log.rcode[3][i] = ir[7];
+      log.time[1][i] = max(now - ir[3]/1000.0,log.time[0][i]);
+      log.time[2][i] = now;
+      for( int u = 0 ; u < 4 ; u++ ) {
+        log.usage[u][i] = ir[3+u];
+      }
       break;
     }
   }
-  return n;
+  update_status(ir[0]);
 }
 
 //============================================================================//
-void Mpidp::clear_JobControl()
-// clear _JobControl
+string Mpidp::history_key(const string &line)
+// runtime history key : hash of PARAM and the table line (spaces are normalized)
 //============================================================================//
 {
-  for( int i = 0 ; i < _Table_list.size() ; i++ ) {
-    _JobControl[i].task_id   = 0;
-    _JobControl[i].ready     = 0;
-    _JobControl[i].run       = 0;
-    _JobControl[i].done      = 0;
+  unsigned long long h = 14695981039346656037ULL;
+  string s = _Param + '\n';
+  char key[32];
+
+  for( size_t i = 0 ; i < line.size() ; i++ ) {
+    if( line[i] != ' ' && line[i] != '\t' ) {
+      s += line[i];
+    }
+    else if( s[s.size()-1] != ' ' && s[s.size()-1] != '\n' ) {
+      s += ' ';
+    }
   }
+  if( s[s.size()-1] == ' ' ) s.erase(s.size()-1);
+
+  hash_data(h,s.c_str(),s.size());
+  sprintf(key,"%016llx",h);
+  return key;
 }
 
 //============================================================================//
-int Mpidp::getNotRunRank(const int &nproc)
-// get rank at run = 0 
+void Mpidp::read_history(ofstream &logout)
+// read the runtime history and predict the run time of each job (-hs file)
+//   line : key <TAB> mean run time (sec) <TAB> # of samples <TAB> run times
+//   (run times are separated by comma, and the prediction is their mean)
 //============================================================================//
 {
-  for( int i = 1 ; i < nproc ; i++ ) {
-    if(_Workerlog[i].run == 0 ) return i;
+  int tbsize = table_size();
+
+  _History.clear();
+  ifstream Input(_History_file.c_str(),ios::in);
+  if( Input ) {
+    string line;
+    char key[32];
+    double sec;
+    int nrun;
+    while( getline(Input,line) ) {
+      if( line.empty() || line[0] == '#' ) continue;
+      if( sscanf(line.c_str(),"%31s\t%lf\t%d",key,&sec,&nrun) == 3 ) {
+        deque<double> &hist = _History[key];
+        string runs = get_column(line,4);
+        for( size_t pos = 0 ; pos < runs.size() ; ) {
+          size_t end = runs.find(',',pos);
+          if( end == string::npos ) {
+            end = runs.size();
+          }
+          hist.push_back(atof(runs.substr(pos,end-pos).c_str()));
+          pos = end + 1;
+        }
+        if( hist.empty() ) {
+          hist.push_back(sec);    // a file without run times
+        }
+      }
+    }
+  }
+
+  _History_key.resize(tbsize);
+  _Predict.assign(tbsize,-1.0);
+  _Npredict = 0;
+  double total = 0.0;
+  for( int i = 0 ; i < tbsize ; i++ ) {
+    _History_key[i] = history_key(table_line(i));
+    map<string,deque<double> >::iterator it = _History.find(_History_key[i]);
+    if( it != _History.end() ) {
+      _Predict[i] = accumulate(it->second.begin(),it->second.end(),0.0) / it->second.size();
+      total += _Predict[i];
+      _Npredict ++;
+    }
+  }
+
+  logout << "#Predicted JOB = " << _Npredict << " (run time " << total << " sec.)" << endl << endl;
+}
+
+//============================================================================//
+void Mpidp::write_history()
+// add run times of successful jobs to the runtime history (-hs file)
+//   the last 8 run times of each job are kept, and the file is replaced by rename()
+//============================================================================//
+{
+  if( _History_file.empty() ) return;
+
+  for( int i = 0 ; i < table_size() ; i++ ) {
+    NameLog &log = _Namelog[i];
+    for( int j = log.worker.size()-1 ; j >= 0 ; j-- ) {
+      if( log.rcode[3][j] ) continue;    // a cache hit does not run the job
+      if( log.rcode[0][j] && log.rcode[1][j] == 0 && (log.rcode[2][j] == 1 || _Out_option == 0) ) {
+        deque<double> &hist = _History[_History_key[i]];
+        hist.push_back(log.usage[0][j] / 1000.0);
+        if( hist.size() > 8 ) {
+          hist.pop_front();
+        }
+        break;
+      }
+    }
+  }
+
+  char tmp[32];
+  sprintf(tmp,".%d",(int)getpid());
+  string path = _History_file + tmp;
+
+  ofstream Output(path.c_str(),ios::out | ios::trunc);
+  Output << "#MPIDP history" << endl;
+  for( map<string,deque<double> >::iterator it = _History.begin() ; it != _History.end() ; it++ ) {
+    deque<double> &hist = it->second;
+    Output << it->first << "\t" << accumulate(hist.begin(),hist.end(),0.0) / hist.size()
+           << "\t" << hist.size() << "\t";
+    for( int k = 0 ; k < hist.size() ; k++ ) {
+      Output << (k ? "," : "") << hist[k];
+    }
+    Output << endl;
+  }
+  Output.close();
+
+  if( !Output || rename(path.c_str(),_History_file.c_str()) != 0 ) {
+    cerr << "[WARNING] History file [" << _History_file << "] was not written." << endl;
+    unlink(path.c_str());
   }
-  return -1;
 }
@@ -19,19 +19,64 @@
 #include <sstream>
 #include <time.h>
 #include <map>
+#include <algorithm>
+#include <numeric>
+#include <deque>
+#include <queue>
 #include <sys/time.h>
 #include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <spawn.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
 #include <mpi.h>
 
 using namespace std;
 
+// result of a job : [job id][RET][FILE][wall][user][sys] (msec) [max RSS] (KB)
+//                   [CACHE] (1: output from the result cache)
+#define RESULT_SIZE 8
+
+// compiled table file (-cp) : header + sections (8 byte aligned)
+//   title, param, line offsets (njob+1), column pointers (njob+1),
+//   column offsets in each line, task ids, depend job ids (CSR), text
+#define TABLE_MAGIC   "MPIDPTB1"
+#define TABLE_VERSION 1
+typedef struct {
+  char       magic[8];     // TABLE_MAGIC
+  int        version;      // TABLE_VERSION
+  int        job_order;    // -jo of the table
+  long long  size;         // file size
+  long long  njob;         // # of table lines
+  long long  ncolumn;      // # of columns of all lines
+  long long  ndep;         // # of depend job ids
+  long long  csize;        // the longest line
+  long long  title_len;    // -1 : no TITLE
+  long long  param_len;    // -1 : no PARAM
+  long long  title;        // offset of each section in the file
+  long long  param;
+  long long  offset;       // long long x (njob+1)
+  long long  column_ptr;   // long long x (njob+1)
+  long long  column_off;   // int x ncolumn
+  long long  task_id;      // int x njob (JOB ORDER mode)
+  long long  dep_ptr;      // int x (njob+1)
+  long long  dep_idx;      // int x ndep
+  long long  text;         // char x offset[njob]
+} TableHeader;
+
 // JOB management table
 typedef struct {
   string  name;    // Job name
   int    exec;    // EXEC
   int    status;    // calculation control flag
   vector<int>  worker;    // WID
-  vector<int>  rcode[3];  // 0:END 1:RET 2:FILE
+  vector<int>  rcode[4];  // 0:END 1:RET 2:FILE 3:CACHE
+  vector<double> time[3]; // 0:dispatch 1:start 2:end (sec, -1: not returned)
+  vector<int>  usage[4];  // 0:wall 1:user 2:sys (msec) 3:max RSS (KB)
 } NameLog;
 
 // JOB control table
@@ -40,8 +85,7 @@ typedef struct {
   int           ready;          // ready execution
   int           run;            // during execution
   int           done;           // done execution
-  vector<int>  depend;    // job ids (depend)
-  vector<int>  depended;  // job ids (depended)
+  int           nwait;          // # of depend jobs not done yet
 } JobControl;
 
 // Worker management table
@@ -49,9 +93,32 @@ typedef struct {
   vector<string> name;    // Job name
   vector<int>    rcode;   // 0: failure 1:success
   int    failure;  // calculation failure counter
-  int    run;      // runing rank
+  int    run;      // # of running jobs
+  int    queue;    // # of messages not returned
+  vector<int>    jobid;   // Job id
+  int    lost;     // 1: no answer (heartbeat or deadline)
+  double heard;    // last message from the rank
+  double deadline; // all jobs sent to the rank must be returned by
 } WorkerLog;
 
+// JOB message (received by workers)
+typedef struct {
+  int           retry;    // Retry counter
+  vector<int>   jobid;    // job ids
+  vector<char>  ctable;   // table lines
+  vector<int>   offset;   // offset of each line in ctable
+} JobMessage;
+
+// Job slot of a worker (a running child process)
+typedef struct {
+  pid_t   pid;      // process id (0: free)
+  int     msg;      // serial number of the message
+  int     line;     // line in the message
+  string  out_file; // output file checked at the end
+  string  key;      // result cache key ("": not cached)
+  double  start;    // start time
+} JobSlot;
+
 class Mpidp
 {
  private:
@@ -65,17 +132,112 @@ class Mpidp
   int      _Worker_life;
   string    _Title;
   string    _Param;
-  char      _Name[7];
-  vector<string>  _Table_list;
+  char      _Name[16];
+  string    _Table_text;          // all table lines (no separator)
+  vector<long long> _Table_offset;  // offset of each line in _Table_text (+ end)
+  int      _Table_njob;           // # of table lines
+  const char      *_Table_base;   // table lines (_Table_text or mapped file)
+  const long long *_Table_index;  // offset of each line (+ end)
+  const long long *_Column_ptr;   // first column of each line (NULL: not compiled)
+  const int       *_Column_off;   // offset of each column in its line
+  string    _Compile_file;        // compiled table to write (-cp)
+  vector<char>    _Sendbuf;   // packed message buffer
   NameLog    *_Namelog;
   WorkerLog    *_Workerlog;
   int      _Csize;
   int      _Psize;
   int      _Ndata;
+  int      _Chunk;        // chunk size (minimum for guided and factoring)
+  int      _Chunk_mode;   // 0:fixed 1:guided 2:factoring
+  int      _Chunk_batch;  // remaining chunks in a factoring batch
+  int      _Chunk_factor; // chunk size of the factoring batch
 
-  map<int,int>    _jobid_map;   // < task id , job id >
-  map<int,int>    _taskid_map;  // < job id , task id >
+  vector<int>   _Dep_ptr;      // depend job ids of job i : _Dep_idx[_Dep_ptr[i].._Dep_ptr[i+1]-1]
+  vector<int>   _Dep_idx;
+  vector<int>   _Child_ptr;    // depended job ids of job i : _Child_idx[_Child_ptr[i].._Child_ptr[i+1]-1]
+  vector<int>   _Child_idx;
+  int           _Id_base;      // task id -> job id : _Id_index[task id - _Id_base]
+  vector<int>   _Id_index;
+  vector<pair<int,int> > _Id_sorted;  // < task id , job id > (sparse task ids)
   JobControl    *_JobControl;
+  deque<int>    _Ready_queue;  // ready job ids
+  priority_queue<pair<double,int> > _Ready_heap;  // < bottom level , -job id >
+  int      _Priority;
+  int      _Cost_column;
+  vector<double>  _Cost;      // cost of each job
+  vector<double>  _Blevel;    // bottom level (critical path length)
+  vector<int>     _Order;     // dispatch order of jobs (NO JOB ORDER mode)
+  string   _History_file;         // runtime history ("": none)
+  map<string,deque<double> > _History;  // key -> the last run times (sec)
+  vector<string>  _History_key;   // history key of each job
+  vector<double>  _Predict;       // run time predicted by history (-1: unknown)
+  int      _Npredict;             // # of jobs with a prediction
+  vector<string>  _Host;          // host name of each rank (master)
+  int      _Host_column;          // preferred host column (0: none)
+  double   _Host_delay;           // time a job waits for its host (sec)
+  vector<int>     _Host_id;       // node of each rank (-1: no node)
+  vector<deque<int> > _Host_queue;  // jobs preferring each node (last: no node)
+  vector<double>  _Host_since;    // time the first job of _Host_queue[] got first
+  vector<char>    _Taken;         // the job was sent (locality mode)
+  double   _Wakeup;               // recv_result() returns -2 at this time (0: never)
+  int      _Nnode;                // # of nodes with ranks under the master
+  int      _Core_column;          // cores column (0: 1 core)
+  int      _Mem_column;           // memory column (MB) (0: none)
+  int      _Node_core;            // cores of a node (0: job slots of the node)
+  double   _Node_mem;             // memory of a node (MB) (0: no limit)
+  vector<int>     _Job_core;      // cores of each job
+  vector<double>  _Job_mem;       // memory of each job (MB)
+  vector<int>     _Job_node;      // node running each job (-1: none)
+  vector<int>     _Free_core;     // free cores of each node
+  vector<double>  _Free_mem;      // free memory of each node (MB)
+  deque<int>      _Pack_queue;    // jobs not sent (packing mode)
+  int      _Pack_head;            // first job of _Pack_queue with a reserved node
+  int      _Pack_reserve;         // node reserved for _Pack_head (-1: none)
+  int      _Pack;                 // 1: packing mode (-rc, -rm)
+  vector<deque<int> > _Node_rank;  // ranks with free messages on each node (packing)
+  vector<int>     _Node_free;     // free messages of each node (packing)
+  vector<char>    _Listed;        // the rank is in _Node_rank[]
+  int      _Prefetch;             // # of messages queued on a worker
+  int      _Slot;                 // # of jobs run at once on a worker
+  int      _Launcher;             // 0: /bin/sh 1: direct (/bin/sh for shell syntax)
+  vector<vector<int> > _Free_rank;  // ranks by # of queued messages
+  int      _Hierarchy;            // # of sub-masters per node (0: none)
+  int      _Parent;               // rank which sends jobs to this rank
+  vector<int>   _Member;          // ranks which receive jobs from this rank
+  vector<int>   _Weight;          // # of workers under each rank
+  string   _Journal_file;         // completion journal ("": none)
+  int      _Restart;              // 1: jobs finished in the journal are skipped
+  int      _Journal_fd;
+  string   _Journal_buf;          // records not written yet
+  int      _Journal_nsync;        // # of records not synced yet
+  double   _Journal_time;         // last fsync
+  vector<int>   _Done;            // 1: finished in a previous run or up to date
+  int      _Ndone;
+  int      _Make;                 // 1: jobs with up-to-date output are skipped
+  vector<int>   _In_column;       // input file columns (files separated by comma)
+  map<string,double> _Mtime;      // modification time of files (-1: not found)
+  vector<int>   _Topo_order;      // topological order of jobs (JOB ORDER mode)
+  string   _Cache_dir;            // result cache directory ("": none)
+  vector<int>   _Same;            // next job with the same table line (-1: none)
+  double   _Heartbeat;            // heartbeat interval of workers (0: none)
+  double   _Beat;                 // time of the last heartbeat (workers, sub-masters)
+  double   _Deadline;             // time limit of each job (0: none)
+  int      _Watch;                // 1: master checks heartbeats and deadlines
+  int      _Lost;                 // rank found lost by recv_result()
+  int      _Nlost;                // # of lost ranks
+  int      _Backup;               // 1: backup copies of the last running jobs
+  double   _Start_time;           // time origin of _Namelog[].time
+  string   _Trace_file;           // trace of the run ("": none)
+  vector<pair<double,int> > _Release;  // < time , job id > made ready by its parents
+  string   _Status_file;          // status snapshot of the run ("": none)
+  double   _Status_interval;      // interval of status snapshots (sec)
+  double   _Status_time;          // time of the last snapshot
+  int      _Status_ndone;         // # of done jobs at the last snapshot
+  vector<char> _Status_state;     // state of each job (see job_State())
+  vector<int>  _Status_weight;    // # of jobs counted by each job (same lines)
+  int      _Status_count[5];      // # of jobs in each state
+  double   _Status_predict;       // predicted run time of jobs not finished (-hs)
+  double   _Status_pmean;         // predicted run time of a job without history
 
  protected:
   virtual string  erase_space(const string &s0,const int ip);
@@ -84,14 +246,96 @@ class Mpidp
   virtual int    for_worker(int &retry,char *ctable,int argc2,char **wargv);
   virtual void    for_worker(int &retry,char *ctable,int &ia,string &argv_joblist);
   virtual string  replace_pattern(const string &pattern,const string &position,const string &option);
-  virtual int    count_comma(const string &str);
+  virtual void    make_Id_index(const vector<int> &task_id);
+  virtual int    task2job(const int task_id);
+  virtual int    mpidp_option(const char *arg);
+  virtual void    add_line(const char *line,const size_t len);
+  virtual int    table_size();
+  virtual const char *table_ptr(const int i);
+  virtual int    table_len(const int i);
+  virtual string  table_line(const int i);
+  virtual string  table_column(const int i,const int col);
+  virtual int    map_table(vector<int> &task_id,int &csize,ofstream &logout);
+  virtual int    check_table(const TableHeader &head,const char *base);
+  virtual void    compile_table(const vector<int> &task_id,const int csize,ofstream &logout);
+  virtual string  get_column(const string &line,const int col);
+  virtual void    make_Cost();
+  virtual void    read_history(ofstream &logout);
+  virtual string  history_key(const string &line);
+  virtual void    make_Blevel(ofstream &logout);
+  virtual void    make_Order(ofstream &logout);
   virtual void    clear_JobControl();
-  virtual int    getNotRunRank(const int &proc);
+  virtual void    initNotRunRank();
+  virtual int    capacity(const int wid);
+  virtual int    getNotRunRank();
+  virtual int    getIdleRank();
+  virtual void    make_Node(map<string,int> &node);
+  virtual void    make_Host_queue(const vector<int> &todo);
+  virtual void    make_Pack(ofstream &logout);
+  virtual int    fit_Node(const int jobid);
+  virtual int    getNodeRank(const int node);
+  virtual int    getPackRank(vector<int> &chunk);
+  virtual void    release_Pack(const int jobid);
+  virtual int    local_job(const int wid,const double now);
+  virtual int    getLocalRank(vector<int> &chunk,const int remain,const int nworker);
+  virtual void    putNotRunRank(const int wid);
+  virtual void    dispatch(const int wid,const int *jobid,const int njob,const int retry);
+  virtual void    finish_Workerlog(const int wid,const int jobid);
+  virtual int    chunk_size(const int remain,const int nworker);
+  virtual void    send_job(const int wid,const int *jobid,const int njob,const int retry);
+  virtual void    send_job(const int wid,const int retry,const int njob,const int *jobid,
+                           const char * const *line,const int *len);
+  virtual int    recv_result(vector<int> &ir);
+  virtual void    send_heartbeat(const int busy);
+  virtual int    check_Worker();
+  virtual double  next_Due();
+  virtual int    lost_Worker(const int wid,deque<int> &jobs);
+  virtual int    retry_job(const int jobid,vector<deque<int> > &level);
+  virtual void    set_Namelog(const int wid,const int *ir);
+  virtual void    recv_job(deque<JobMessage> &jobqueue);
+  virtual void    recv_job(JobMessage &job);
+  virtual pid_t   spawn_job(const string &command);
+  virtual int    split_command(const string &command,vector<string> &args);
+  virtual void    read_journal(ofstream &logout);
+  virtual void    write_journal(const int jobid,const int ret,const int file);
+  virtual void    flush_journal(const int sync);
+  virtual void    make_Uptodate(ofstream &logout);
+  virtual int    isUptodate(const int jobid);
+  virtual double  file_mtime(const string &file);
+  virtual void    split_columns(const string &col,vector<int> &column);
+  virtual void    worker_option(int argc,char *argv[]);
+  virtual void    make_Same(ofstream &logout);
+  virtual void    hash_data(unsigned long long &h,const char *data,const size_t len);
+  virtual string  cache_key(const string &command,const string &line);
+  virtual int    read_cache(const string &key,const string &out_file,int &ret);
+  virtual void    write_cache(const string &key,const string &out_file,const int ret);
+  virtual int    copy_file(const string &src,const string &dst);
  public:
   Mpidp() {
 #ifdef DEBUG
     cout << "Constructing Mpidp.\n";
 #endif
+    // members read by every rank (options are read by the master only)
+    _Journal_fd = -1;
+    _Heartbeat = 0.0;
+    _Beat = 0.0;
+    _Deadline = 0.0;
+    _Backup = 0;
+    _Watch = 0;
+    _Lost = 0;
+    _Nlost = 0;
+    _Status_time = -1.0;
+    _Npredict = 0;
+    _Host_column = 0;
+    _Wakeup = 0.0;
+    _Core_column = 0;
+    _Mem_column = 0;
+    _Pack = 0;
+    _Table_njob = 0;
+    _Table_base = NULL;
+    _Table_index = NULL;
+    _Column_ptr = NULL;
+    _Column_off = NULL;
   }
   virtual ~Mpidp() {
 #ifdef DEBUG
@@ -103,12 +347,25 @@ class Mpidp
   virtual int    master(const int &nproc);
   virtual int    master1(const int &nproc);
   virtual void    worker(int &myid,char *hostname,int argc,char *argv[]);
+  virtual void    submaster(int &myid,int argc,char *argv[]);
+  virtual void    make_Hierarchy(int argc,char *argv[],const int &nproc,const int &myid,
+                                 char *hostall,ofstream &logout);
+  virtual int    isSubmaster();
   virtual void    write_table(const int &nproc,ofstream &logout);
+  virtual void    write_trace(const int &nproc);
+  virtual void    write_status(const int force);
+  virtual int    job_State(const int i);
+  virtual void    update_status(const int i);
+  virtual void    write_history();
+  virtual void    open_journal();
+  virtual void    close_journal();
 
   int      _Job_order;
+  virtual int    compileOnly(const int &nproc);
   virtual int           getNextReadyJobID();
+  virtual int           countReadyJobID();
+  virtual void          pushReadyJobID(int jobid);
   virtual void          resetReadyJobID(int &jobid);
-  virtual int           checkDependTaskID(int &jobid);
   virtual void          writeJobControl();
 };
 
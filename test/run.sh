@@ -10,11 +10,83 @@ mpidp="../mpidp"
 table="./table/table.new4";
 ################################################
 
-mpi_opt="--allow-run-as-root"
+mpi_opt="--allow-run-as-root --oversubscribe"
+nfail=0
+
+# check <0: success, 1: error> <# of ranks> <MPIDP options>
+check() {
+  expect=$1
+  np=$2
+  shift 2
+  echo "mpirun $mpi_opt -np $np $mpidp $*"
+  if mpirun $mpi_opt -np $np $mpidp "$@" < /dev/null > /dev/null 2>&1; then
+    result=0
+  else
+    result=1
+  fi
+  if [ $result -eq $expect ]; then
+    echo "  ... OK"
+  else
+    echo "  ... NG"
+    nfail=`expr $nfail + 1`
+  fi
+}
+
+# check_file <file> : the file was written
+check_file() {
+  if [ -s $1 ]; then
+    echo "  ... OK ($1)"
+  else
+    echo "  ... NG ($1)"
+    nfail=`expr $nfail + 1`
+  fi
+}
+
+# check_log <log file> <line> : the line is in the log file
+check_log() {
+  if grep -q "$2" $1; then
+    echo "  ... OK ($2)"
+  else
+    echo "  ... NG ($2)"
+    nfail=`expr $nfail + 1`
+  fi
+}
 
 echo "START>>> mpidp"
 
 echo "mpirun $mpi_opt -np 4 $mpidp -tb $table -jo 1"
 mpirun $mpi_opt -np 4 $mpidp -tb $table -jo 1
 
-echo "END>>>>> mpidp"
+# JOB ORDER mode : depend ids and broken tables
+rm -f ls_out.*
+check 0 4 -tb ./table/table.dag -jo 1
+check_file ls_out.d4
+check 1 4 -tb ./table/table.cycle -jo 1
+check 1 4 -tb ./table/table.badid -jo 1
+check 1 4 -tb ./table/table.emptydep -jo 1
+check 1 4 -tb ./table/table.nodep -jo 1
+check 1 4 -tb ./table/table.dupid -jo 1
+
+# journal (-jn) : a restart (-rs) runs only the jobs not finished
+rm -f ls_out.*
+check 0 4 -tb ./table/table.jn -jo 1 -jn ls_out.jn -lg ls_out.log1
+touch ls_out.go
+check 0 4 -tb ./table/table.jn -jo 1 -jn ls_out.jn -rs 1 -lg ls_out.log2
+check_log ls_out.log2 "#Finished JOB in journal = 2"
+check_log ls_out.log2 "00002.*EXEC=1 .*RET=0"
+check 1 4 -tb ./table/table.dag -jo 1 -jn ls_out.jn -rs 1
+
+# compiled table (-cp) : made by a single rank, and mapped at startup
+#   a table of another -jo and broken tables are rejected
+rm -f ls_out.*
+check 0 1 -tb ./table/table.dag -jo 1 -cp ls_out.cp
+check 0 4 -tb ls_out.cp -jo 1
+check_file ls_out.d4
+check 1 4 -tb ls_out.cp -jo 0
+head -c 200 ls_out.cp > ls_out.cp1
+check 1 4 -tb ls_out.cp1 -jo 1
+cp ls_out.cp ls_out.cp2
+printf '\377\377' | dd of=ls_out.cp2 bs=1 seek=24 conv=notrunc 2> /dev/null
+check 1 4 -tb ls_out.cp2 -jo 1
+
+echo "END>>>>> mpidp ($nfail NG)"